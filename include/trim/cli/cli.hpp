@@ -1,8 +1,12 @@
 #pragma once
+#include <trim/color/depth.hpp>
 #include <trim/color/rgb.hpp>
+#include <trim/layout/make_layout.hpp>
 #include <trim/style/style.hpp>
 #include <trim/util/assert.hpp>
+#include <trim/util/geometry.hpp>
 
+#include <array>
 #include <optional>
 #include <span>
 #include <string>
@@ -109,6 +113,14 @@ namespace trim::cli
     }
   };
 
+  // what the tree is written as
+  enum class Output_Format
+  {
+    TEXT,
+    SVG,
+    HTML
+  };
+
   struct Options
   {
     std::optional<std::string_view> input_file_name {};
@@ -131,6 +143,28 @@ namespace trim::cli
     std::optional<int> node_min_width {};
     std::optional<int> node_min_height {};
 
+    // line, column, height and width relative to the top left corner of the scene
+    std::optional<Rect> viewport {};
+
+    // number of threads laying out and drawing the output, 0 uses one thread per core
+    std::optional<int> num_threads {};
+
+    bool trim_trailing_blanks {};
+    std::optional<int> cursor_skip {};
+
+    // std::nullopt means detect the depth of the terminal
+    std::optional<std::optional<Color_Depth>> color_depth {};
+
+    std::optional<Output_Format> format {};
+
+    // print the size of the output in bytes instead of the output
+    bool measure {};
+
+    // redraw the input file every this many seconds, writing only the changed cells
+    std::optional<int> live_interval {};
+
+    std::optional<Layout_Engine> layout_engine {};
+
     std::vector<std::string> errors {};
   };
 
@@ -142,6 +176,8 @@ namespace trim::cli
       return trim::thick_style;
     if(string == "double")
       return trim::double_style;
+    if(string == "ascii")
+      return trim::ascii_style;
     return std::nullopt;
   }
 
@@ -254,6 +290,43 @@ namespace trim::cli
     return parse_color_name(string);
   }
 
+  // parses a color depth, 'auto' gives an empty depth
+  [[nodiscard]] constexpr std::optional<std::optional<Color_Depth>> parse_color_depth(std::string_view string) noexcept
+  {
+    using result_type = std::optional<std::optional<Color_Depth>>;
+    if(string == "auto")
+      return result_type(std::optional<Color_Depth>());
+    if(string == "truecolor" || string == "24bit")
+      return result_type(Color_Depth::TRUECOLOR);
+    if(string == "256")
+      return result_type(Color_Depth::ANSI_256);
+    if(string == "16")
+      return result_type(Color_Depth::ANSI_16);
+    if(string == "none")
+      return result_type(Color_Depth::NONE);
+    return std::nullopt;
+  }
+
+  [[nodiscard]] constexpr std::optional<Output_Format> parse_format(std::string_view string) noexcept
+  {
+    if(string == "text")
+      return Output_Format::TEXT;
+    if(string == "svg")
+      return Output_Format::SVG;
+    if(string == "html")
+      return Output_Format::HTML;
+    return std::nullopt;
+  }
+
+  [[nodiscard]] constexpr std::optional<Layout_Engine> parse_layout_engine(std::string_view string) noexcept
+  {
+    if(string == "contour")
+      return Layout_Engine::CONTOUR;
+    if(string == "walker")
+      return Layout_Engine::WALKER;
+    return std::nullopt;
+  }
+
   [[nodiscard]] constexpr std::optional<int> parse_small_positive_int(std::string_view string) noexcept
   {
     int result = 0;
@@ -271,6 +344,34 @@ namespace trim::cli
     return result;
   }
 
+  // parses 'line,column,height,width', height and width must be at least 1
+  [[nodiscard]] constexpr std::optional<Rect> parse_viewport(std::string_view string) noexcept
+  {
+    std::array<coord_type, 4> values {};
+
+    for(std::size_t i = 0; i < values.size(); ++i) {
+      std::size_t const comma_pos = string.find(',');
+      std::string_view const digits = string.substr(0, comma_pos);
+
+      if(digits.empty() || digits.size() > 9 || (comma_pos == string.npos) != (i + 1 == values.size()))
+        return std::nullopt;
+
+      for(char c : digits) {
+        if(c < '0' || c > '9')
+          return std::nullopt;
+        values[i] = values[i] * 10 + c - '0';
+      }
+
+      string.remove_prefix(comma_pos == string.npos ? string.size() : comma_pos + 1);
+    }
+
+    auto const [line, column, height, width] = values;
+    if(height < 1 || width < 1)
+      return std::nullopt;
+
+    return Rect(Point(line, column), Point(line + height - 1, column + width - 1));
+  }
+
   [[nodiscard]] constexpr Options parse_args(std::span<char const* const> args)
   {
     Parser parser = Parser(args);
@@ -290,7 +391,16 @@ namespace trim::cli
       LINE_MARGIN,
       SIBLING_MARGIN,
       HORIZONTAL_PADDING,
-      VERTICAL_PADDING
+      VERTICAL_PADDING,
+      VIEWPORT,
+      THREADS,
+      TRIM_TRAILING,
+      CURSOR_SKIP,
+      COLOR_DEPTH,
+      FORMAT,
+      MEASURE,
+      LIVE,
+      LAYOUT
     };
 
     auto const get_option_kind = [](std::string_view name) -> OptionKind {
@@ -319,6 +429,24 @@ namespace trim::cli
         return HORIZONTAL_PADDING;
       if(name == "vertical-padding")
         return VERTICAL_PADDING;
+      if(name == "viewport")
+        return VIEWPORT;
+      if(name == "threads")
+        return THREADS;
+      if(name == "trim-trailing")
+        return TRIM_TRAILING;
+      if(name == "cursor-skip")
+        return CURSOR_SKIP;
+      if(name == "color-depth")
+        return COLOR_DEPTH;
+      if(name == "format")
+        return FORMAT;
+      if(name == "measure")
+        return MEASURE;
+      if(name == "live")
+        return LIVE;
+      if(name == "layout")
+        return LAYOUT;
       return NONE;
     };
 
@@ -472,6 +600,97 @@ namespace trim::cli
             }
             break;
           }
+          case OptionKind::VIEWPORT: {
+            if(option.value == "") {
+              std::string message = "Invalid usage of --viewport. Expected line,column,height,width.";
+              result.errors.push_back(std::move(message));
+            } else if(std::optional<Rect> maybe_viewport = parse_viewport(option.value); maybe_viewport) {
+              result.viewport = *maybe_viewport;
+            } else {
+              std::string message = "Invalid usage of --viewport. Not valid: '"s + std::string(option.value) + "'.";
+              result.errors.push_back(std::move(message));
+            }
+            break;
+          }
+          case OptionKind::THREADS: {
+            if(option.value == "") {
+              std::string message = "Invalid usage of --threads. Expected a positive integer < 1000.";
+              result.errors.push_back(std::move(message));
+            } else if(std::optional<int> maybe_int = parse_small_positive_int(option.value); maybe_int) {
+              result.num_threads = *maybe_int;
+            } else {
+              std::string message = "Invalid usage of --threads. Not valid: '"s + std::string(option.value) + "'.";
+              result.errors.push_back(std::move(message));
+            }
+            break;
+          }
+          case OptionKind::TRIM_TRAILING: {
+            result.trim_trailing_blanks = true;
+            break;
+          }
+          case OptionKind::CURSOR_SKIP: {
+            if(option.value == "") {
+              std::string message = "Invalid usage of --cursor-skip. Expected a positive integer < 1000.";
+              result.errors.push_back(std::move(message));
+            } else if(std::optional<int> maybe_int = parse_small_positive_int(option.value); maybe_int && *maybe_int > 0) {
+              result.cursor_skip = *maybe_int;
+            } else {
+              std::string message = "Invalid usage of --cursor-skip. Not valid: '"s + std::string(option.value) + "'.";
+              result.errors.push_back(std::move(message));
+            }
+            break;
+          }
+          case OptionKind::COLOR_DEPTH: {
+            if(option.value == "") {
+              std::string message = "Invalid usage of --color-depth. Expected auto|truecolor|256|16|none.";
+              result.errors.push_back(std::move(message));
+            } else if(auto maybe_depth = parse_color_depth(option.value); maybe_depth) {
+              result.color_depth = *maybe_depth;
+            } else {
+              std::string message = "Invalid usage of --color-depth. Unrecognized depth '"s + std::string(option.value) + "'.";
+              result.errors.push_back(std::move(message));
+            }
+            break;
+          }
+          case OptionKind::FORMAT: {
+            if(option.value == "") {
+              std::string message = "Invalid usage of --format. Expected text|svg|html.";
+              result.errors.push_back(std::move(message));
+            } else if(std::optional<Output_Format> maybe_format = parse_format(option.value); maybe_format) {
+              result.format = *maybe_format;
+            } else {
+              std::string message = "Invalid usage of --format. Unrecognized format '"s + std::string(option.value) + "'.";
+              result.errors.push_back(std::move(message));
+            }
+            break;
+          }
+          case OptionKind::MEASURE: {
+            result.measure = true;
+            break;
+          }
+          case OptionKind::LIVE: {
+            if(option.value == "") {
+              result.live_interval = 1;
+            } else if(std::optional<int> maybe_int = parse_small_positive_int(option.value); maybe_int && *maybe_int > 0) {
+              result.live_interval = *maybe_int;
+            } else {
+              std::string message = "Invalid usage of --live. Not valid: '"s + std::string(option.value) + "'.";
+              result.errors.push_back(std::move(message));
+            }
+            break;
+          }
+          case OptionKind::LAYOUT: {
+            if(option.value == "") {
+              std::string message = "Invalid usage of --layout. Expected contour|walker.";
+              result.errors.push_back(std::move(message));
+            } else if(std::optional<Layout_Engine> maybe_engine = parse_layout_engine(option.value); maybe_engine) {
+              result.layout_engine = *maybe_engine;
+            } else {
+              std::string message = "Invalid usage of --layout. Unrecognized engine '"s + std::string(option.value) + "'.";
+              result.errors.push_back(std::move(message));
+            }
+            break;
+          }
         }
       }
     }
@@ -484,7 +703,7 @@ namespace trim::cli
     return R"EOF(
 Usage: trim [--input=file_name] [--style=styleName] [--style-parameter=value] [--help]
   --input               | read from the given file instead of stdin
-  --style               | configure a style (default, thin, thick, double)
+  --style               | configure a style (default, thin, thick, double, ascii)
   --tree-align          | configure tree alignment (left, center, right)
   --text-style          | configure the text style (bold, italic, underline)
   --text-align          | enable label alignment (left, center, right)
@@ -495,6 +714,15 @@ Usage: trim [--input=file_name] [--style=styleName] [--style-parameter=value] [-
   --sibling-margin      | configure horizontal margin between sibling nodes
   --horizontal-padding  | configure horizontal label padding
   --vertical-padding    | configure vertical label padding
+  --viewport            | only draw the window line,column,height,width of the scene
+  --threads             | number of threads laying out and drawing the output (0 for one per core)
+  --trim-trailing       | do not pad lines with trailing blanks
+  --cursor-skip         | on a terminal, move the cursor over runs of at least this many blanks
+  --color-depth         | colors written (truecolor, 256, 16, none, auto detects the terminal)
+  --format              | output format (text, svg, html)
+  --measure             | print the size of the output in bytes instead of writing it
+  --live                | redraw the input file every second (or every --live=n seconds), only changed cells are written
+  --layout              | layout engine (contour, walker for linear time on large trees)
 )EOF";
   }
 } // namespace trim::cli
@@ -0,0 +1,85 @@
+#pragma once
+#include <trim/color/rgb.hpp>
+
+#include <algorithm>
+#include <array>
+
+namespace trim
+{
+  // number of colors a terminal can display
+  enum class Color_Depth
+  {
+    NONE = 0,
+    ANSI_16 = 1,
+    ANSI_256 = 2,
+    TRUECOLOR = 3
+  };
+
+  namespace detail
+  {
+    [[nodiscard]] constexpr int color_distance(Color_RGB lhs, Color_RGB rhs) noexcept
+    {
+      int const red = lhs.red - rhs.red;
+      int const green = lhs.green - rhs.green;
+      int const blue = lhs.blue - rhs.blue;
+      return red * red + green * green + blue * blue;
+    }
+
+    // the levels of each channel of the 6x6x6 cube of the 256 color palette
+    constexpr inline std::array<int, 6> cube_levels = {0, 95, 135, 175, 215, 255};
+
+    [[nodiscard]] constexpr int nearest_cube_level(int value) noexcept
+    {
+      auto const distance = [value](int level) noexcept { return level > value ? level - value : value - level; };
+
+      int result = 0;
+      for(int i = 1; i < 6; ++i) {
+        if(distance(cube_levels[i]) < distance(cube_levels[result]))
+          result = i;
+      }
+      return result;
+    }
+  } // namespace detail
+
+  // clang-format off
+
+  // the usual (xterm) values of the 16 basic colors, the bright ones are 8 to 15
+  constexpr inline std::array<Color_RGB, 16> ansi_16_colors = {
+    Color_RGB(0, 0, 0),       Color_RGB(205, 0, 0),     Color_RGB(0, 205, 0),     Color_RGB(205, 205, 0),
+    Color_RGB(0, 0, 238),     Color_RGB(205, 0, 205),   Color_RGB(0, 205, 205),   Color_RGB(229, 229, 229),
+    Color_RGB(127, 127, 127), Color_RGB(255, 0, 0),     Color_RGB(0, 255, 0),     Color_RGB(255, 255, 0),
+    Color_RGB(92, 92, 255),   Color_RGB(255, 0, 255),   Color_RGB(0, 255, 255),   Color_RGB(255, 255, 255)
+  };
+
+  // clang-format on
+
+  // returns the closest of the 16 basic colors
+  [[nodiscard]] constexpr int nearest_ansi_16(Color_RGB color) noexcept
+  {
+    int result = 0;
+    for(int i = 1; i < 16; ++i) {
+      if(detail::color_distance(ansi_16_colors[i], color) < detail::color_distance(ansi_16_colors[result], color))
+        result = i;
+    }
+    return result;
+  }
+
+  // returns the closest color of the 256 color palette, from the 6x6x6 cube (16 to 231) or the gray ramp (232 to 255)
+  [[nodiscard]] constexpr int nearest_ansi_256(Color_RGB color) noexcept
+  {
+    int const red = detail::nearest_cube_level(color.red);
+    int const green = detail::nearest_cube_level(color.green);
+    int const blue = detail::nearest_cube_level(color.blue);
+    Color_RGB const cube = Color_RGB(detail::cube_levels[red], detail::cube_levels[green], detail::cube_levels[blue]);
+
+    // gray levels are 8, 18, ..., 238
+    int const average = (color.red + color.green + color.blue) / 3;
+    int const gray_index = std::clamp((average - 3) / 10, 0, 23);
+    int const gray_level = 8 + gray_index * 10;
+    Color_RGB const gray = Color_RGB(gray_level, gray_level, gray_level);
+
+    if(detail::color_distance(gray, color) < detail::color_distance(cube, color))
+      return 232 + gray_index;
+    return 16 + 36 * red + 6 * green + blue;
+  }
+} // namespace trim
@@ -1,8 +1,11 @@
 #pragma once
 #include <trim/util/splitmix64.hpp>
 
+#include <array>
 #include <compare>
+#include <cstddef>
 #include <cstdint>
+#include <initializer_list>
 
 namespace trim
 {
@@ -137,10 +140,33 @@ namespace trim
     return Color_RGB(r, g, b);
   }
 
+  // the longest output of format_color_hex
+  constexpr inline std::size_t color_hex_size = 7;
+
+  // writes the color as #rrggbb, as used by CSS and SVG
+  constexpr char* format_color_hex(char* out, Color_RGB color) noexcept
+  {
+    constexpr char hex_digits[] = "0123456789abcdef";
+    *out++ = '#';
+    for(int channel : {color.red, color.green, color.blue}) {
+      *out++ = hex_digits[(channel >> 4) & 0xF];
+      *out++ = hex_digits[channel & 0xF];
+    }
+    return out;
+  }
+
+  // pick_rainbow(double) sampled at 1024 points, so that picking a color from a seed is a table lookup
+  constexpr inline std::array<Color_RGB, 1024> rainbow_colors = []() {
+    std::array<Color_RGB, 1024> result {};
+    for(std::size_t i = 0; i < result.size(); ++i)
+      result[i] = pick_rainbow(double(i) / double(result.size()));
+    return result;
+  }();
+
   [[nodiscard]] constexpr Color_RGB pick_rainbow(std::uint_least64_t seed) noexcept
   {
     std::uint_least64_t hash = trim::splitmix64(seed);
-    return pick_rainbow((hash % 1024) / 1024.0);
+    return rainbow_colors[hash % rainbow_colors.size()];
   }
 
 } // namespace trim
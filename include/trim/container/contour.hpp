@@ -1,17 +1,124 @@
 #pragma once
+#include <trim/util/assert.hpp>
+
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
-#include <iostream>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace trim
 {
+  struct Contour;
+  struct Contour_Journal;
+
+  /*!
+   * Storage of the elements of the left or the right contours of one layout.
+   * Each node has its own element, linked by index, so prepending and splicing contours
+   * never moves an element and the elements of all the contours are released at once with the pool.
+   * A node is added to a single contour of a pool. Contours of disjoint subtrees only touch
+   * the elements of their own nodes, so they can be built on different threads.
+   */
+  struct Contour_Pool
+  {
+    using size_type = std::size_t;
+
+    static constexpr size_type npos = static_cast<size_type>(-1);
+
+    struct Link
+    {
+      long offset {};
+      size_type next = npos;
+    };
+
+    private:
+
+    std::vector<Link> m_links {};
+    Contour_Journal* m_journal {};
+
+    friend struct Contour;
+    friend struct Contour_Journal;
+
+    public:
+
+    Contour_Pool() = default;
+
+    explicit constexpr Contour_Pool(size_type num_nodes)
+      : m_links(num_nodes)
+      , m_journal()
+    {}
+
+    [[nodiscard]] constexpr size_type size() const noexcept
+    {
+      return m_links.size();
+    }
+
+    // elements of new nodes are added at the end, the elements of the other nodes are unchanged
+    constexpr void resize(size_type num_nodes)
+    {
+      m_links.resize(num_nodes);
+    }
+
+    // every later change to an element is recorded in journal, until it is set to nullptr
+    constexpr void record_changes(Contour_Journal* journal) noexcept
+    {
+      m_journal = journal;
+    }
+
+    private:
+
+    constexpr void write(size_type link, Link value);
+  };
+
+  /*!
+   * The previous values of the elements changed in one or more pools.
+   * Undoing the changes of a range restores the elements as they were before it,
+   * provided the changes recorded after the range were undone first.
+   */
+  struct Contour_Journal
+  {
+    using size_type = std::size_t;
+
+    struct Change
+    {
+      Contour_Pool* pool {};
+      size_type link {};
+      Contour_Pool::Link previous {};
+    };
+
+    std::vector<Change> changes {};
+
+    [[nodiscard]] constexpr size_type size() const noexcept
+    {
+      return changes.size();
+    }
+
+    // restores the elements changed in [begin, end), the latest change first
+    constexpr void undo(size_type begin, size_type end) const
+    {
+      for(size_type i = end; i-- > begin;) {
+        Change const& change = changes[i];
+        change.pool->m_links[change.link] = change.previous;
+      }
+    }
+  };
+
+  constexpr void Contour_Pool::write(size_type link, Link value)
+  {
+    if(m_journal != nullptr)
+      m_journal->changes.push_back(Contour_Journal::Change {.pool = this, .link = link, .previous = m_links[link]});
+    m_links[link] = value;
+  }
+
   /*!
    * Stores a left or right contour of a subtree.
    * A contour is a list of vertices and offsets
    * The offset represents a positive/negative horizontal
    * displacement from the previous node in the contour.
    * The offset of the first node is always 0.
+   * The list is singly linked in a Contour_Pool: push_front and push_back take constant time,
+   * and a merge only walks the shorter of the two contours before splicing the rest of the longer one.
    *
    * Example:
    * Given the following tree
@@ -56,80 +163,175 @@ namespace trim
 
     using size_type = std::size_t;
     using ssize_type = std::make_signed_t<size_type>;
-    using list_type = std::vector<Element>;
     using value_type = Element;
-    using reference = Element&;
-    using const_reference = Element const&;
     using offset_type = long;
-    using iterator = typename list_type::iterator;
-    using const_iterator = typename list_type::const_iterator;
+
+    // where the elements of a contour are in its pool
+    struct Span
+    {
+      size_type head = Contour_Pool::npos;
+      size_type tail = Contour_Pool::npos;
+      size_type size {};
+    };
+
+    // visits the elements from the front, yielding them by value
+    struct const_iterator
+    {
+      using value_type = Element;
+      using difference_type = std::ptrdiff_t;
+
+      Contour_Pool const* pool {};
+      size_type link = Contour_Pool::npos;
+
+      [[nodiscard]] constexpr Element operator*() const noexcept
+      {
+        return Element(link, pool->m_links[link].offset);
+      }
+
+      constexpr const_iterator& operator++() noexcept
+      {
+        link = pool->m_links[link].next;
+        return *this;
+      }
+
+      constexpr const_iterator operator++(int) noexcept
+      {
+        const_iterator result = *this;
+        ++*this;
+        return result;
+      }
+
+      [[nodiscard]] constexpr bool operator==(const_iterator const& other) const noexcept
+      {
+        return link == other.link;
+      }
+    };
 
     private:
 
-    list_type elements {};
+    static constexpr size_type npos = Contour_Pool::npos;
+
+    Contour_Pool* m_pool {};
+    size_type m_head = npos;
+    size_type m_tail = npos;
+    size_type m_size {};
 
     public:
 
     Contour() = default;
 
-    constexpr Contour(list_type elements) noexcept
-      : elements(std::move(elements))
+    explicit constexpr Contour(Contour_Pool& pool) noexcept
+      : m_pool(&pool)
     {}
 
+    // the contour of a span, while none of its elements changed since the span was taken
+    constexpr Contour(Contour_Pool& pool, Span span) noexcept
+      : m_pool(&pool)
+      , m_head(span.head)
+      , m_tail(span.tail)
+      , m_size(span.size)
+    {}
+
+    // contours own their elements, moving one leaves it empty
+    constexpr Contour(Contour&& other) noexcept
+      : m_pool(other.m_pool)
+      , m_head(std::exchange(other.m_head, npos))
+      , m_tail(std::exchange(other.m_tail, npos))
+      , m_size(std::exchange(other.m_size, 0))
+    {}
+
+    constexpr Contour& operator=(Contour&& other) noexcept
+    {
+      if(this != &other) {
+        m_pool = other.m_pool;
+        m_head = std::exchange(other.m_head, npos);
+        m_tail = std::exchange(other.m_tail, npos);
+        m_size = std::exchange(other.m_size, 0);
+      }
+      return *this;
+    }
+
+    Contour(Contour const&) = delete;
+    Contour& operator=(Contour const&) = delete;
+
     [[nodiscard]] constexpr size_type size() const
     {
-      return elements.size();
+      return m_size;
     }
 
     [[nodiscard]] constexpr ssize_type ssize() const noexcept
     {
-      return static_cast<ssize_type>(elements.size());
+      return static_cast<ssize_type>(m_size);
+    }
+
+    [[nodiscard]] constexpr Span span() const noexcept
+    {
+      return Span {.head = m_head, .tail = m_tail, .size = m_size};
     }
 
-    [[nodiscard]] constexpr reference operator[](size_type index)
+    [[nodiscard]] constexpr Element front() const noexcept
     {
-      return elements[index];
+      return *begin();
     }
 
-    [[nodiscard]] constexpr const_reference operator[](size_type index) const
+    // the offset of the first element, the displacement of the whole contour
+    constexpr void set_front_offset(offset_type offset) noexcept
     {
-      return elements[index];
+      m_pool->write(m_head, Contour_Pool::Link {.offset = offset, .next = m_pool->m_links[m_head].next});
     }
 
     constexpr void push_back(size_type node, offset_type offset)
     {
-      elements.push_back(Element(node, offset));
+      size_type const link = allocate(node, offset, npos);
+      if(m_tail == npos)
+        m_head = link;
+      else
+        m_pool->write(m_tail, Contour_Pool::Link {.offset = m_pool->m_links[m_tail].offset, .next = link});
+      m_tail = link;
+      m_size += 1;
     }
 
     constexpr void push_front(size_type node, offset_type offset)
     {
-      elements.insert(elements.begin(), Element(node, offset));
+      m_head = allocate(node, offset, m_head);
+      if(m_tail == npos)
+        m_tail = m_head;
+      m_size += 1;
     }
 
+    // extends this contour with the part of other below its last element, other is left empty
     constexpr void merge(Contour&& other)
     {
+      TRIM_ASSERT(other.m_head == npos || m_pool == other.m_pool);
+
       offset_type offset1 = 0;
       offset_type offset2 = 0;
 
-      size_type pos1 = 0;
-      size_type pos2 = 0;
+      size_type link1 = m_head;
+      size_type link2 = other.m_head;
 
-      while(pos1 < size() && pos2 < other.size()) {
-        offset1 += elements[pos1].offset;
-        offset2 += other[pos2].offset;
-        ++pos1;
-        ++pos2;
+      while(link1 != npos && link2 != npos) {
+        offset1 += m_pool->m_links[link1].offset;
+        offset2 += m_pool->m_links[link2].offset;
+        link1 = m_pool->m_links[link1].next;
+        link2 = m_pool->m_links[link2].next;
       }
 
-      if(pos1 < other.size()) {
-        push_back(other[pos1].node, (offset2 + other[pos2].offset) - offset1);
-        ++pos1;
+      if(link2 != npos) {
+        // the first spliced element is displaced from the last element of this contour
+        Contour_Pool::Link const first = m_pool->m_links[link2];
+        m_pool->write(link2, Contour_Pool::Link {.offset = (offset2 + first.offset) - offset1, .next = first.next});
+        if(m_tail == npos)
+          m_head = link2;
+        else
+          m_pool->write(m_tail, Contour_Pool::Link {.offset = m_pool->m_links[m_tail].offset, .next = link2});
+        m_tail = other.m_tail;
+        m_size = other.m_size;
       }
 
-      while(pos1 < other.size()) {
-        push_back(other[pos1].node, other[pos1].offset);
-        ++pos1;
-      }
+      other.m_head = npos;
+      other.m_tail = npos;
+      other.m_size = 0;
     }
 
     template<typename Width_Fn>
@@ -139,13 +341,14 @@ namespace trim
       offset_type x2 = 0;
       offset_type result = 0;
 
-      size_type pos1 = 0;
-      size_type pos2 = 0;
+      const_iterator pos1 = c1.begin();
+      const_iterator pos2 = c2.begin();
 
-      while(pos1 < c1.size() && pos2 < c2.size()) {
-        x1 += c1[pos1].offset;
-        x2 += c2[pos2].offset;
-        offset_type right_edge = x1 + width_map(c1[pos1].node);
+      while(pos1 != c1.end() && pos2 != c2.end()) {
+        Element const element1 = *pos1;
+        x1 += element1.offset;
+        x2 += (*pos2).offset;
+        offset_type right_edge = x1 + width_map(element1.node);
 
         if(right_edge > x2)
           result = std::max(result, right_edge - x2);
@@ -159,18 +362,20 @@ namespace trim
 
     [[nodiscard]] constexpr const_iterator begin() const
     {
-      return elements.begin();
+      return const_iterator {.pool = m_pool, .link = m_head};
     }
 
     [[nodiscard]] constexpr const_iterator end() const
     {
-      return elements.end();
+      return const_iterator {.pool = m_pool, .link = npos};
     }
 
+    // empties the contour, its elements are only released with the pool
     constexpr void clear()
     {
-      elements.clear();
-      elements = list_type();
+      m_head = npos;
+      m_tail = npos;
+      m_size = 0;
     }
 
     template<typename Stream>
@@ -180,13 +385,155 @@ namespace trim
       char const* delim = "";
 
       stream << "contour[";
-      for(Element const& element : contour) {
+      for(Element const element : contour) {
+        offset += element.offset;
         stream << delim << "(" << element.node << ", " << offset << ")";
         delim = ", ";
-        offset += element.offset;
       }
       stream << "]";
       return stream;
     }
+
+    private:
+
+    // the element of a node is its index in the pool
+    [[nodiscard]] constexpr size_type allocate(size_type node, offset_type offset, size_type next)
+    {
+      TRIM_ASSERT(node < m_pool->m_links.size());
+      m_pool->write(node, Contour_Pool::Link {.offset = offset, .next = next});
+      return node;
+    }
+  };
+
+  /*!
+   * Storage of persistent contours, which are never changed once made.
+   * An element stores the offset of the next element, so contours sharing their tail can start
+   * at different offsets. Elements are only added, they are released at once with the pool.
+   */
+  struct Persistent_Contour_Pool
+  {
+    using size_type = std::size_t;
+
+    static constexpr size_type npos = static_cast<size_type>(-1);
+
+    struct Element
+    {
+      size_type node {};
+      long next_offset {};
+      size_type next = npos;
+    };
+
+    std::vector<Element> elements {};
+  };
+
+  /*!
+   * A left or right contour shared by several subtrees, as a handle to a list of a Persistent_Contour_Pool.
+   * Copying a contour is free. The offset of the first element is kept by the handle, and a merge copies
+   * the elements of this contour instead of changing them, so it costs the length of this contour
+   * like the merge of Contour does when this contour is the shorter one.
+   */
+  struct Persistent_Contour
+  {
+    using size_type = std::size_t;
+    using offset_type = long;
+
+    private:
+
+    static constexpr size_type npos = Persistent_Contour_Pool::npos;
+
+    Persistent_Contour_Pool* m_pool {};
+    size_type m_head = npos;
+    offset_type m_front {};
+    size_type m_size {};
+
+    public:
+
+    Persistent_Contour() = default;
+
+    explicit constexpr Persistent_Contour(Persistent_Contour_Pool& pool) noexcept
+      : m_pool(&pool)
+    {}
+
+    [[nodiscard]] constexpr size_type size() const noexcept
+    {
+      return m_size;
+    }
+
+    constexpr void set_front_offset(offset_type offset) noexcept
+    {
+      m_front = offset;
+    }
+
+    constexpr void push_front(size_type node, offset_type offset)
+    {
+      m_pool->elements.push_back(Persistent_Contour_Pool::Element {.node = node, .next_offset = m_front, .next = m_head});
+      m_head = m_pool->elements.size() - 1;
+      m_front = offset;
+      m_size += 1;
+    }
+
+    // extends this contour with the part of other below its last element, other is unchanged
+    constexpr void merge(Persistent_Contour const& other)
+    {
+      if(other.m_size <= m_size)
+        return;
+      if(m_size == 0) {
+        *this = other;
+        return;
+      }
+
+      std::vector<Persistent_Contour_Pool::Element>& elements = m_pool->elements;
+      offset_type offset1 = m_front;
+      offset_type offset2 = other.m_front;
+      size_type link1 = m_head;
+      size_type link2 = other.m_head;
+      size_type const head = elements.size();
+
+      // the elements of this contour are copied, the last one is linked to the rest of other
+      for(size_type depth = 0; depth < m_size; ++depth) {
+        Persistent_Contour_Pool::Element const element = elements[link1];
+        elements.push_back(Persistent_Contour_Pool::Element {.node = element.node, .next_offset = element.next_offset, .next = elements.size() + 1});
+        if(depth + 1 == m_size) {
+          // the next element of other is displaced from the last element of this contour
+          elements.back().next_offset = (offset2 + elements[link2].next_offset) - offset1;
+          elements.back().next = elements[link2].next;
+        } else {
+          offset1 += element.next_offset;
+          offset2 += elements[link2].next_offset;
+        }
+        link1 = element.next;
+        link2 = elements[link2].next;
+      }
+
+      m_head = head;
+      m_size = other.m_size;
+    }
+
+    template<typename Width_Fn>
+    [[nodiscard]] friend constexpr offset_type minimum_offset(Persistent_Contour const& c1, Persistent_Contour const& c2, Width_Fn width_map) noexcept
+    {
+      std::vector<Persistent_Contour_Pool::Element> const& elements = c1.m_pool->elements;
+      offset_type x1 = c1.m_front;
+      offset_type x2 = c2.m_front;
+      offset_type result = 0;
+
+      size_type link1 = c1.m_head;
+      size_type link2 = c2.m_head;
+      while(link1 != npos && link2 != npos) {
+        Persistent_Contour_Pool::Element const& element1 = elements[link1];
+        Persistent_Contour_Pool::Element const& element2 = elements[link2];
+        offset_type right_edge = x1 + width_map(element1.node);
+
+        if(right_edge > x2)
+          result = std::max(result, right_edge - x2);
+
+        x1 += element1.next_offset;
+        x2 += element2.next_offset;
+        link1 = element1.next;
+        link2 = element2.next;
+      }
+
+      return result;
+    }
   };
 } // namespace trim
@@ -0,0 +1,111 @@
+#pragma once
+#include <trim/util/assert.hpp>
+#include <trim/util/geometry.hpp>
+#include <trim/util/ints.hpp>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace trim
+{
+  /*!
+   * Uniform grid over a set of rectangles, used to answer point queries
+   * without testing every rectangle.
+   * The bounding rect is split into buckets of bucket_height x bucket_width cells.
+   * Each bucket stores the indices of the rectangles overlapping it, in increasing order,
+   * packed contiguously: the indices of bucket 'b' are items[offsets[b], offsets[b + 1]).
+   */
+  struct Rect_Grid
+  {
+    using size_type = std::size_t;
+    using index_type = std::uint32_t;
+
+    static constexpr coord_type bucket_height = 8;
+    static constexpr coord_type bucket_width = 16;
+
+    private:
+
+    Rect m_bounds {};
+    coord_type m_lines {};
+    coord_type m_columns {};
+    std::vector<index_type> m_offsets {};
+    std::vector<index_type> m_items {};
+
+    public:
+
+    Rect_Grid() = default;
+
+    constexpr Rect_Grid(std::span<Rect const> rects, Rect bounds)
+      : m_bounds(bounds)
+      , m_lines((trim::height(bounds) / bucket_height) + 1)
+      , m_columns((trim::width(bounds) / bucket_width) + 1)
+      , m_offsets(static_cast<size_type>(m_lines * m_columns) + 1, 0)
+      , m_items()
+    {
+      // first pass counts the rectangles in every bucket, second pass fills the buckets
+      for_each_bucket(rects, [&](size_type bucket, size_type) {
+        m_offsets[bucket + 1] += 1;
+      });
+
+      for(size_type i = 1; i < m_offsets.size(); ++i)
+        m_offsets[i] += m_offsets[i - 1];
+
+      m_items.resize(m_offsets.back());
+      std::vector<index_type> cursor = std::vector<index_type>(m_offsets.begin(), m_offsets.end() - 1);
+      for_each_bucket(rects, [&](size_type bucket, size_type index) {
+        m_items[cursor[bucket]] = static_cast<index_type>(index);
+        cursor[bucket] += 1;
+      });
+    }
+
+    [[nodiscard]] constexpr bool empty() const noexcept
+    {
+      return m_offsets.empty();
+    }
+
+    /*!
+     * Returns the indices of the rectangles that may contain the point, in increasing order.
+     */
+    [[nodiscard]] constexpr std::span<index_type const> query(Point point) const noexcept
+    {
+      if(empty() || !trim::envelopes(m_bounds, point))
+        return {};
+
+      size_type const bucket = bucket_of(point.line, point.column);
+      index_type const begin = m_offsets[bucket];
+      index_type const end = m_offsets[bucket + 1];
+      return std::span<index_type const>(m_items.data() + begin, end - begin);
+    }
+
+    private:
+
+    [[nodiscard]] constexpr size_type bucket_of(coord_type line, coord_type column) const noexcept
+    {
+      coord_type const bucket_line = (line - top_line(m_bounds)) / bucket_height;
+      coord_type const bucket_column = (column - left_column(m_bounds)) / bucket_width;
+      return static_cast<size_type>(bucket_line * m_columns + bucket_column);
+    }
+
+    template<typename Fn>
+    constexpr void for_each_bucket(std::span<Rect const> rects, Fn callback) const
+    {
+      for(size_type index = 0; index < rects.size(); ++index) {
+        Rect const rect = rects[index];
+        TRIM_ASSERT(trim::envelopes(m_bounds, top_left_corner(rect)));
+        TRIM_ASSERT(trim::envelopes(m_bounds, bot_right_corner(rect)));
+
+        coord_type const line1 = (top_line(rect) - top_line(m_bounds)) / bucket_height;
+        coord_type const line2 = (bot_line(rect) - top_line(m_bounds)) / bucket_height;
+        coord_type const column1 = (left_column(rect) - left_column(m_bounds)) / bucket_width;
+        coord_type const column2 = (right_column(rect) - left_column(m_bounds)) / bucket_width;
+
+        for(coord_type line = line1; line <= line2; ++line) {
+          for(coord_type column = column1; column <= column2; ++column) {
+            callback(static_cast<size_type>(line * m_columns + column), index);
+          }
+        }
+      }
+    }
+  };
+} // namespace trim
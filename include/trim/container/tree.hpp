@@ -1,6 +1,7 @@
 #pragma once
 #include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace trim
@@ -63,6 +64,10 @@ namespace trim
     }
   };
 
+  /*!
+   * Calls callback on every node reachable from root, children before their parent.
+   * The traversal keeps its own stack, so the depth of the tree is only limited by memory.
+   */
   template<std::invocable<std::size_t> Callback>
   constexpr void tree_visit_postorder(Tree const& tree, std::size_t root, Callback callback)
   {
@@ -71,19 +76,30 @@ namespace trim
     std::size_t const N = tree.size();
     auto visited = std::vector<bit_type>(N, false);
 
-    auto const recurse = [&](auto& rec, std::size_t curr) -> void {
-      visited[curr] = true;
-      for(std::size_t i = 0; i < tree.num_children(curr); ++i) {
-        std::size_t child = tree.get_child(curr, i);
+    // nodes on the path from the root, with the index of the next child to visit
+    std::vector<std::pair<std::size_t, std::size_t>> stack {};
+    visited[root] = true;
+    stack.emplace_back(root, 0);
+    while(!stack.empty()) {
+      auto& [curr, index] = stack.back();
+      if(index < tree.num_children(curr)) {
+        std::size_t child = tree.get_child(curr, index++);
         if(!visited[child]) {
-          rec(rec, child);
+          visited[child] = true;
+          stack.emplace_back(child, 0);
         }
+        continue;
       }
-      callback(curr);
-    };
-    recurse(recurse, root);
+
+      std::size_t const node = curr;
+      stack.pop_back();
+      callback(node);
+    }
   }
 
+  /*!
+   * Calls callback on every node reachable from root, parents before their children.
+   */
   template<std::invocable<std::size_t> Callback>
   constexpr void tree_visit_preorder(Tree const& tree, std::size_t root, Callback callback)
   {
@@ -92,17 +108,77 @@ namespace trim
     std::size_t const N = tree.size();
     auto visited = std::vector<bit_type>(N, false);
 
-    auto const recurse = [&](auto& rec, std::size_t curr) -> void {
-      visited[curr] = true;
-      callback(curr);
-      for(std::size_t i = 0; i < tree.num_children(curr); ++i) {
-        std::size_t child = tree.get_child(curr, i);
-        if(!visited[child]) {
-          rec(rec, child);
-        }
+    std::vector<std::pair<std::size_t, std::size_t>> stack {};
+    visited[root] = true;
+    callback(root);
+    stack.emplace_back(root, 0);
+    while(!stack.empty()) {
+      auto& [curr, index] = stack.back();
+      if(index == tree.num_children(curr)) {
+        stack.pop_back();
+        continue;
+      }
+
+      std::size_t child = tree.get_child(curr, index++);
+      if(!visited[child]) {
+        visited[child] = true;
+        callback(child);
+        stack.emplace_back(child, 0);
       }
-    };
-    recurse(recurse, root);
+    }
+  }
+
+  /*!
+   * The nodes reachable from a root in preorder, with the position of the parent of each node in that order.
+   * Passes that only need parents before children (or children before parents, looping backwards)
+   * can run over these arrays instead of following the adjacency lists again.
+   */
+  struct Tree_Preorder
+  {
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    std::vector<std::size_t> nodes {};
+    // parents[i] is the position of the parent of nodes[i], npos for the root
+    std::vector<std::size_t> parents {};
+
+    [[nodiscard]] constexpr std::size_t size() const noexcept
+    {
+      return nodes.size();
+    }
+  };
+
+  [[nodiscard]] constexpr Tree_Preorder tree_preorder(Tree const& tree, std::size_t root)
+  {
+    using bit_type = char8_t;
+
+    Tree_Preorder result {};
+    result.nodes.reserve(tree.size());
+    result.parents.reserve(tree.size());
+    auto visited = std::vector<bit_type>(tree.size(), false);
+
+    std::vector<std::pair<std::size_t, std::size_t>> stack {};
+    visited[root] = true;
+    result.nodes.push_back(root);
+    result.parents.push_back(Tree_Preorder::npos);
+    stack.emplace_back(0, 0);
+    while(!stack.empty()) {
+      auto& [position, index] = stack.back();
+      std::size_t const curr = result.nodes[position];
+      if(index == tree.num_children(curr)) {
+        stack.pop_back();
+        continue;
+      }
+
+      std::size_t const parent = position;
+      std::size_t const child = tree.get_child(curr, index++);
+      if(!visited[child]) {
+        visited[child] = true;
+        result.nodes.push_back(child);
+        result.parents.push_back(parent);
+        stack.emplace_back(result.nodes.size() - 1, 0);
+      }
+    }
+    return result;
   }
 
   template<std::ranges::range Output_Range>
@@ -0,0 +1,356 @@
+#pragma once
+#include <trim/container/contour.hpp>
+#include <trim/container/labels.hpp>
+#include <trim/container/tree.hpp>
+#include <trim/layout/layout_metrics.hpp>
+#include <trim/layout/make_layout.hpp>
+#include <trim/layout/tree_layout.hpp>
+#include <trim/style/style.hpp>
+#include <trim/util/assert.hpp>
+#include <trim/util/geometry.hpp>
+#include <trim/util/ints.hpp>
+#include <trim/util/string.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace trim
+{
+  /*!
+   * A contour layout kept up to date while its tree is edited.
+   * Besides the offsets of the nodes, the layout keeps where the contours of every subtree are
+   * and the changes each placement made to the contours of the children. An edit undoes the placements
+   * on the path from the edited node to the root and places that path again, then the rects of the subtrees
+   * that moved are shifted. An edit costs the depth of the edited node and the size of the moved subtrees,
+   * a label changing the height of a level also moves every level below it.
+   * Nodes in the tree get the rects of make_layout on the edited tree, removed nodes get an empty rect.
+   * Like the nodes make_layout can't reach from the root, removed nodes no longer count in the height of their level.
+   * The layout refers to its own tree, it can't be copied or moved.
+   */
+  struct Incremental_Layout
+  {
+    private:
+
+    static constexpr size_type npos = Tree_Preorder::npos;
+
+    Tree m_tree {};
+    size_type m_root {};
+    Labels m_labels {};
+    Style m_style {};
+    Tree_Layout m_layout {};
+
+    // the parent and level of every node, npos for nodes out of the tree
+    std::vector<size_type> m_parents {};
+    std::vector<size_type> m_levels {};
+    std::vector<ssize_type> m_widths {};
+    std::vector<ssize_type> m_heights {};
+
+    // the nodes of every level and the position of every node in its level
+    std::vector<std::vector<size_type>> m_level_nodes {};
+    std::vector<size_type> m_level_positions {};
+    // how many nodes of every level have each height, by increasing height, and the line of every level
+    std::vector<std::vector<std::pair<ssize_type, size_type>>> m_level_height_counts {};
+    std::vector<ssize_type> m_level_lines {};
+
+    // the changes of the last placement of every node are [m_changes_begin, m_changes_end) in the journal
+    Contour_Journal m_journal {};
+    std::vector<size_type> m_changes_begin {};
+    std::vector<size_type> m_changes_end {};
+    size_type m_live_changes {};
+    std::vector<std::pair<Contour::Span, Contour::Span>> m_spans {};
+
+    detail::Contour_Placer m_placer;
+
+    public:
+
+    constexpr Incremental_Layout(Tree tree, size_type root, Labels node_labels, Style const& style)
+      : m_tree(std::move(tree))
+      , m_root(root)
+      , m_labels(std::move(node_labels))
+      , m_style(style)
+      , m_layout()
+      , m_parents(m_tree.size(), npos)
+      , m_levels(m_tree.size(), npos)
+      , m_widths()
+      , m_heights()
+      , m_level_nodes()
+      , m_level_positions(m_tree.size(), npos)
+      , m_level_height_counts()
+      , m_level_lines()
+      , m_journal()
+      , m_changes_begin(m_tree.size(), 0)
+      , m_changes_end(m_tree.size(), 0)
+      , m_live_changes(0)
+      , m_spans(m_tree.size())
+      , m_placer(m_tree, m_widths, m_style)
+    {
+      Layout_Metrics metrics = trim::compute_layout_metrics(m_tree, m_root, m_labels, m_style);
+      Tree_Preorder const& order = metrics.order;
+      m_widths = std::move(metrics.widths);
+      m_heights = std::move(metrics.heights);
+
+      for(size_type i = 0; i < order.size(); ++i) {
+        size_type const node = order.nodes[i];
+        m_parents[node] = (i == 0 ? npos : order.nodes[order.parents[i]]);
+        m_levels[node] = static_cast<size_type>(metrics.levels[node]);
+        add_to_level(node);
+      }
+      update_level_lines();
+
+      // children come after their parent in preorder
+      m_placer.record_changes(&m_journal);
+      for(size_type i = order.size(); i-- > 0;)
+        place(order.nodes[i]);
+
+      m_layout = Tree_Layout(m_tree.size());
+      m_layout[m_root] = Node_Layout(node_rect(m_root, 0));
+      for(size_type i = 1; i < order.size(); ++i) {
+        size_type const node = order.nodes[i];
+        coord_type const parent_column = left_column(m_layout[m_parents[node]].rect);
+        m_layout[node] = Node_Layout(node_rect(node, parent_column + m_placer.offsets()[node]));
+      }
+    }
+
+    Incremental_Layout(Incremental_Layout const&) = delete;
+    Incremental_Layout& operator=(Incremental_Layout const&) = delete;
+
+    [[nodiscard]] constexpr Tree const& tree() const noexcept
+    {
+      return m_tree;
+    }
+
+    [[nodiscard]] constexpr size_type root() const noexcept
+    {
+      return m_root;
+    }
+
+    [[nodiscard]] constexpr Labels const& labels() const noexcept
+    {
+      return m_labels;
+    }
+
+    [[nodiscard]] constexpr Tree_Layout const& layout() const noexcept
+    {
+      return m_layout;
+    }
+
+    // adds a node after the last child of parent, returns the new node
+    constexpr size_type add_node(size_type parent, String label)
+    {
+      TRIM_ASSERT(m_levels[parent] != npos);
+
+      size_type const node = m_tree.size();
+      m_tree.adjacency.emplace_back();
+      m_tree.add_child(parent, node);
+      m_labels.labels.push_back(std::move(label));
+      m_layout.layout.emplace_back();
+
+      Node_Size const size = trim::compute_node_size(m_labels(node), m_style);
+      m_parents.push_back(parent);
+      m_levels.push_back(m_levels[parent] + 1);
+      m_widths.push_back(size.width);
+      m_heights.push_back(size.height);
+      m_level_positions.push_back(npos);
+      m_changes_begin.push_back(0);
+      m_changes_end.push_back(0);
+      m_spans.emplace_back();
+      m_placer.resize(m_tree.size());
+
+      add_to_level(node);
+      relayout(node);
+      return node;
+    }
+
+    // removes node and its subtree from the tree, the root can't be removed
+    constexpr void remove_subtree(size_type node)
+    {
+      TRIM_ASSERT(node != m_root && m_levels[node] != npos);
+
+      size_type const parent = m_parents[node];
+      std::erase(m_tree.adjacency[parent], node);
+
+      std::vector<size_type> stack = {node};
+      while(!stack.empty()) {
+        size_type const curr = stack.back();
+        stack.pop_back();
+        for(size_type child : m_tree.adjacency[curr])
+          stack.push_back(child);
+
+        remove_from_level(curr);
+        m_live_changes -= m_changes_end[curr] - m_changes_begin[curr];
+        m_changes_begin[curr] = 0;
+        m_changes_end[curr] = 0;
+        m_parents[curr] = npos;
+        m_levels[curr] = npos;
+        m_layout[curr] = Node_Layout();
+      }
+
+      relayout(parent);
+    }
+
+    constexpr void set_label(size_type node, String label)
+    {
+      TRIM_ASSERT(m_levels[node] != npos);
+
+      m_labels[node] = std::move(label);
+      Node_Size const size = trim::compute_node_size(m_labels(node), m_style);
+      remove_from_level(node);
+      m_widths[node] = size.width;
+      m_heights[node] = size.height;
+      add_to_level(node);
+      relayout(node);
+    }
+
+    private:
+
+    // places node from the contours of its children, recording the changes to undo it
+    constexpr void place(size_type node)
+    {
+      m_live_changes -= m_changes_end[node] - m_changes_begin[node];
+      m_changes_begin[node] = m_journal.size();
+      m_placer.place(node);
+      m_changes_end[node] = m_journal.size();
+      m_live_changes += m_changes_end[node] - m_changes_begin[node];
+      m_spans[node] = m_placer.contour_spans(node);
+    }
+
+    // places the path from node to the root again, then moves the rects that changed
+    constexpr void relayout(size_type node)
+    {
+      std::vector<size_type> path {};
+      for(size_type curr = node; curr != npos; curr = m_parents[curr])
+        path.push_back(curr);
+
+      // an ancestor was placed after its descendants, its changes are undone first
+      for(size_type i = path.size(); i-- > 0;)
+        m_journal.undo(m_changes_begin[path[i]], m_changes_end[path[i]]);
+
+      for(size_type curr : path) {
+        for(size_type child : m_tree.adjacency[curr])
+          m_placer.restore_contours(child, m_spans[child]);
+        place(curr);
+      }
+
+      std::vector<size_type> const moved_levels = update_level_lines();
+      m_layout[m_root] = Node_Layout(node_rect(m_root, 0));
+      for(size_type i = path.size(); i-- > 0;) {
+        size_type const curr = path[i];
+        coord_type const column = left_column(m_layout[curr].rect);
+        for(size_type child : m_tree.adjacency[curr]) {
+          Rect const rect = node_rect(child, column + m_placer.offsets()[child]);
+          if(i > 0 && child == path[i - 1]) {
+            m_layout[child] = Node_Layout(rect);
+          } else if(left_column(rect) != left_column(m_layout[child].rect)) {
+            move_subtree(child, left_column(rect) - left_column(m_layout[child].rect));
+          }
+        }
+      }
+
+      move_lines(moved_levels);
+      if(m_journal.size() > 2 * m_live_changes + 1024)
+        compact_journal();
+    }
+
+    [[nodiscard]] constexpr Rect node_rect(size_type node, coord_type column) const noexcept
+    {
+      coord_type const line = m_level_lines[m_levels[node]];
+      return Rect(Point(line, column), Point(line + m_heights[node] - 1, column + m_widths[node] - 1));
+    }
+
+    // shifts the rects of a subtree, whose shape is unchanged
+    constexpr void move_subtree(size_type node, coord_type columns)
+    {
+      std::vector<size_type> stack = {node};
+      while(!stack.empty()) {
+        size_type const curr = stack.back();
+        stack.pop_back();
+        m_layout[curr] = Node_Layout(trim::translate(m_layout[curr].rect, 0, columns));
+        for(size_type child : m_tree.adjacency[curr])
+          stack.push_back(child);
+      }
+    }
+
+    // moves the rects of the nodes of levels to the lines of the levels
+    constexpr void move_lines(std::vector<size_type> const& levels)
+    {
+      for(size_type level : levels) {
+        for(size_type node : m_level_nodes[level])
+          m_layout[node] = Node_Layout(node_rect(node, left_column(m_layout[node].rect)));
+      }
+    }
+
+    [[nodiscard]] constexpr ssize_type level_height(size_type level) const noexcept
+    {
+      return m_level_height_counts[level].empty() ? 0 : m_level_height_counts[level].back().first;
+    }
+
+    constexpr void add_to_level(size_type node)
+    {
+      size_type const level = m_levels[node];
+      if(level == m_level_nodes.size()) {
+        m_level_nodes.emplace_back();
+        m_level_height_counts.emplace_back();
+      }
+
+      m_level_positions[node] = m_level_nodes[level].size();
+      m_level_nodes[level].push_back(node);
+
+      std::vector<std::pair<ssize_type, size_type>>& counts = m_level_height_counts[level];
+      auto const pos = std::ranges::lower_bound(counts, m_heights[node], {}, &std::pair<ssize_type, size_type>::first);
+      if(pos != counts.end() && pos->first == m_heights[node])
+        pos->second += 1;
+      else
+        counts.insert(pos, {m_heights[node], 1});
+    }
+
+    constexpr void remove_from_level(size_type node)
+    {
+      size_type const level = m_levels[node];
+      std::vector<size_type>& nodes = m_level_nodes[level];
+      size_type const position = m_level_positions[node];
+      nodes[position] = nodes.back();
+      m_level_positions[nodes[position]] = position;
+      nodes.pop_back();
+      m_level_positions[node] = npos;
+
+      std::vector<std::pair<ssize_type, size_type>>& counts = m_level_height_counts[level];
+      auto const pos = std::ranges::lower_bound(counts, m_heights[node], {}, &std::pair<ssize_type, size_type>::first);
+      TRIM_ASSERT(pos != counts.end() && pos->first == m_heights[node]);
+      if(--pos->second == 0)
+        counts.erase(pos);
+    }
+
+    // returns the levels whose line changed
+    constexpr std::vector<size_type> update_level_lines()
+    {
+      m_level_lines.resize(m_level_nodes.size(), 0);
+
+      std::vector<size_type> moved_levels {};
+      ssize_type line = 0;
+      for(size_type level = 0; level < m_level_nodes.size(); ++level) {
+        if(m_level_lines[level] != line)
+          moved_levels.push_back(level);
+        m_level_lines[level] = line;
+        line += level_height(level) + m_style.level_margin;
+      }
+      return moved_levels;
+    }
+
+    // drops the changes of the placements that were undone or removed
+    constexpr void compact_journal()
+    {
+      Contour_Journal journal {};
+      journal.changes.reserve(m_live_changes);
+      for(size_type node = 0; node < m_tree.size(); ++node) {
+        size_type const begin = journal.size();
+        journal.changes.insert(journal.changes.end(),
+                               m_journal.changes.begin() + ssize_type(m_changes_begin[node]),
+                               m_journal.changes.begin() + ssize_type(m_changes_end[node]));
+        m_changes_begin[node] = begin;
+        m_changes_end[node] = journal.size();
+      }
+      m_journal.changes = std::move(journal.changes);
+    }
+  };
+} // namespace trim
@@ -0,0 +1,101 @@
+#pragma once
+#include <trim/container/labels.hpp>
+#include <trim/container/tree.hpp>
+#include <trim/style/style.hpp>
+#include <trim/util/ints.hpp>
+#include <trim/util/split.hpp>
+
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+namespace trim
+{
+  /*!
+   * The sizes and lines of the nodes, shared by the layout engines.
+   * Nodes on the same level start on the same line, levels are as tall as their tallest node
+   * plus the level margin, so horizontal placement is all that differs between engines.
+   */
+  struct Layout_Metrics
+  {
+    std::vector<ssize_type> levels {};
+    std::vector<ssize_type> widths {};
+    std::vector<ssize_type> heights {};
+    std::vector<ssize_type> lines {};
+    // the nodes reachable from the root
+    Tree_Preorder order {};
+  };
+
+  struct Node_Size
+  {
+    ssize_type width {};
+    ssize_type height {};
+  };
+
+  // the size of the box of a node with the given label
+  [[nodiscard]] constexpr Node_Size compute_node_size(std::string_view label, Style const& style)
+  {
+    // split a string into lines and compute the maximum length of any line
+    size_type max_length = 0;
+    trim::split_string_by_newline(label, [&](std::string_view line) {
+      max_length = std::max(max_length, line.size());
+    });
+
+    ssize_type const text_length = std::max(max_length, size_type(1));
+    ssize_type const text_lines = std::ranges::count(label, '\n') + 1;
+    ssize_type const h_padding = style.node_horizontal_padding * 2;
+    ssize_type const v_padding = style.node_vertical_padding * 2;
+    Node_Size result {};
+    result.width = std::max(style.node_minimum_width, text_length + h_padding + 2);
+    result.height = std::max(style.node_minimum_height, text_lines + v_padding + 2);
+
+    // round up the node width so that the connection points are exactly centered
+    if(result.width % 2 == 0)
+      result.width += 1;
+    return result;
+  }
+
+  [[nodiscard]] constexpr Layout_Metrics compute_layout_metrics(Tree const& tree, size_type root, Labels const& node_labels, Style const& style)
+  {
+    size_type const N = tree.size();
+
+    Layout_Metrics result {};
+    result.levels = std::vector<ssize_type>(N, 0);
+    result.widths = std::vector<ssize_type>(N, 0);
+    result.heights = std::vector<ssize_type>(N, 0);
+    result.lines = std::vector<ssize_type>(N, 0);
+    std::vector<ssize_type> max_level_height = std::vector<ssize_type>(N, 0);
+    std::vector<ssize_type> max_level_margin = std::vector<ssize_type>(N, 0);
+
+    // compute the level of each node
+    // the level is the distance from root, parents come before their children in preorder
+    result.order = trim::tree_preorder(tree, root);
+    for(size_type i = 1; i < result.order.size(); ++i)
+      result.levels[result.order.nodes[i]] = result.levels[result.order.nodes[result.order.parents[i]]] + 1;
+
+    // compute width and height of every node
+    for(size_type node = 0; node < N; ++node) {
+      Node_Size const size = trim::compute_node_size(node_labels(node), style);
+      result.widths[node] = size.width;
+      result.heights[node] = size.height;
+    }
+
+    // for each level, compute the maximum node height and vertical margin on that level
+    // nodes that can't be reached from the root are left at level 0 and don't count
+    for(size_type node : result.order.nodes) {
+      ssize_type const level = result.levels[node];
+      max_level_height[level] = std::max(max_level_height[level], result.heights[node]);
+      max_level_margin[level] = std::max(max_level_margin[level], style.level_margin);
+    }
+
+    // compute the line of every node
+    // the line of a node is the y coordinate of its enclosing box top segment
+    for(size_type i = 1; i < result.order.size(); ++i) {
+      size_type const parent = result.order.nodes[result.order.parents[i]];
+      ssize_type const level = result.levels[parent];
+      result.lines[result.order.nodes[i]] = result.lines[parent] + max_level_height[level] + max_level_margin[level];
+    }
+
+    return result;
+  }
+} // namespace trim
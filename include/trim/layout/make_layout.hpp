@@ -2,138 +2,95 @@
 #include <trim/container/contour.hpp>
 #include <trim/container/labels.hpp>
 #include <trim/container/tree.hpp>
+#include <trim/layout/layout_metrics.hpp>
+#include <trim/layout/subtree_shapes.hpp>
 #include <trim/layout/tree_layout.hpp>
+#include <trim/layout/walker_layout.hpp>
 #include <trim/style/style.hpp>
 #include <trim/util/ints.hpp>
-#include <trim/util/split.hpp>
 
 #include <algorithm>
-#include <iostream>
-#include <string>
-#include <string_view>
+#include <optional>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace trim
 {
-  constexpr Tree_Layout make_layout(            //
-    Tree const& tree,                           //
-    size_type root,                             //
-    Labels const& node_labels,                  //
-    [[maybe_unused]] Labels const& edge_labels, //
-    Style const& style)
+  namespace detail
   {
-    size_type const N = tree.size();
-
-    Tree_Layout result = Tree_Layout(N);
-    std::vector<ssize_type> levels = std::vector<ssize_type>(N, 0);
-    std::vector<ssize_type> max_level_height = std::vector<ssize_type>(N, 0);
-    std::vector<ssize_type> max_level_margin = std::vector<ssize_type>(N, 0);
-    std::vector<ssize_type> lines = std::vector<ssize_type>(N, 0);
-    std::vector<ssize_type> offsets = std::vector<ssize_type>(N, 0);
-    std::vector<ssize_type> node_width = std::vector<ssize_type>(N, 0);
-    std::vector<ssize_type> node_height = std::vector<ssize_type>(N, 0);
-    std::vector<Contour> left_contours = std::vector<Contour>(N);
-    std::vector<Contour> right_contours = std::vector<Contour>(N);
-
-    // returns the precomputed width of a node
-    auto const width_map = [&node_width](size_type node) -> ssize_type {
-      return node_width[node];
-    };
-
-    // split a string into lines and compute the maximum length of any line
-    auto const max_text_line_length = [&](std::string_view string) -> size_type {
-      size_type max_length = 0;
-      trim::split_string_by_newline(string, [&](std::string_view line) {
-        max_length = std::max(max_length, line.size());
-      });
-      return max_length;
-    };
-
-    // compute the level of each node
-    // the level is the distance from root
-    trim::tree_compute_levels(tree, root, levels);
-
-    // compute width and height of every node
-    for(size_type node = 0; node < N; ++node) {
-      ssize_type const text_length = std::max(max_text_line_length(node_labels(node)), size_type(1));
-      ssize_type const text_lines = std::ranges::count(node_labels(node), '\n') + 1;
-      ssize_type const h_padding = style.node_horizontal_padding * 2;
-      ssize_type const v_padding = style.node_vertical_padding * 2;
-      node_width[node] = std::max(style.node_minimum_width, text_length + h_padding + 2);
-      node_height[node] = std::max(style.node_minimum_height, text_lines + v_padding + 2);
-
-      // round up the node width so that the connection points are exactly centered
-      if(node_width[node] % 2 == 0)
-        node_width[node] += 1;
-    }
-
-    // for each level, compute the maximum node height and vertical margin on that level
-    for(size_type node = 0; node < N; ++node) {
-      ssize_type const level = levels[node];
-      ssize_type const height = node_height[node];
-      ssize_type const margin = style.level_margin;
-      max_level_height[level] = std::max(max_level_height[level], height);
-      max_level_margin[level] = std::max(max_level_margin[level], margin);
-    }
-
-    // compute the line of every node
-    // the line of a node is the y coordinate of its enclosing box top segment
-    trim::tree_visit_preorder(tree, root, [&](size_type curr) -> void {
-      for(size_type i = 0; i < tree.num_children(curr); ++i) {
-        size_type child = tree.get_child(curr, i);
-        lines[child] = lines[curr] + max_level_height[levels[curr]] + max_level_margin[levels[curr]];
-      }
-    });
+    /*!
+     * Places the children of curr relative to it from the contours of their subtrees, and returns
+     * the left and right contours of the subtree of curr. The contours are Contour or Persistent_Contour,
+     * children gives access to the children of curr:
+     *  - children.left(i) and children.right(i) take the contours of the i-th child,
+     *  - children.offset(i) is the offset of the i-th child from curr, written by the placement,
+     *  - children.empty_left() and children.empty_right() make empty contours for a leaf.
+     */
+    template<typename Contour_Type, typename Children>
+    [[nodiscard]] constexpr std::pair<Contour_Type, Contour_Type> place_children( //
+      Tree const& tree,                                                        //
+      std::vector<ssize_type> const& widths,                                   //
+      Style const& style,                                                      //
+      size_type curr,                                                          //
+      Children& children)
+    {
+      // returns the precomputed width of a node
+      auto const width_map = [&widths](size_type node) -> ssize_type {
+        return widths[node];
+      };
 
-    // compute offsets and contours
-    trim::tree_visit_postorder(tree, root, [&](size_type curr) -> void {
       size_type const num_children = tree.num_children(curr);
       bool const is_leaf = (num_children == 0);
       bool const is_unary_node = (num_children == 1);
       bool const is_binary_node = (num_children == 2);
 
       if(is_leaf) {
-        offsets[curr] = 0;
-        left_contours[curr].push_back(curr, 0);
-        right_contours[curr].push_back(curr, 0);
-        return;
+        Contour_Type left_contour = children.empty_left();
+        Contour_Type right_contour = children.empty_right();
+        left_contour.push_front(curr, 0);
+        right_contour.push_front(curr, 0);
+        return {std::move(left_contour), std::move(right_contour)};
       }
 
       if(is_unary_node) {
         size_type child = tree.get_child(curr, 0);
         ssize_type w1 = width_map(curr);
         ssize_type w2 = width_map(child);
+        ssize_type& offset = children.offset(0);
+        offset = 0;
 
         if(style.tree_align == Tree_Alignment::CENTER) {
           if(w2 > w1) {
-            offsets[child] = -(w2 - w1 + 1) / 2;
+            offset = -(w2 - w1 + 1) / 2;
           } else if(w2 < w1) {
-            offsets[child] = +(w1 - w2 + 1) / 2;
+            offset = +(w1 - w2 + 1) / 2;
           }
         } else if(style.tree_align == Tree_Alignment::RIGHT) {
           if(w2 > w1) {
-            offsets[child] = -(w2 - w1);
+            offset = -(w2 - w1);
           } else if(w2 < w1) {
-            offsets[child] = +(w1 - w2);
+            offset = +(w1 - w2);
           }
         }
 
-        left_contours[curr] = std::move(left_contours[child]);
-        right_contours[curr] = std::move(right_contours[child]);
-        left_contours[curr][0].offset = offsets[child];
-        right_contours[curr][0].offset = offsets[child];
-        left_contours[curr].push_front(curr, 0);
-        right_contours[curr].push_front(curr, 0);
-
-        return;
+        Contour_Type left_contour = children.left(0);
+        Contour_Type right_contour = children.right(0);
+        left_contour.set_front_offset(offset);
+        right_contour.set_front_offset(offset);
+        left_contour.push_front(curr, 0);
+        right_contour.push_front(curr, 0);
+        return {std::move(left_contour), std::move(right_contour)};
       }
 
       if(is_binary_node) {
-        size_type left_child = tree.get_child(curr, 0);
         size_type right_child = tree.get_child(curr, 1);
+        Contour_Type left_of_left = children.left(0);
+        Contour_Type right_of_left = children.right(0);
+        Contour_Type left_of_right = children.left(1);
+        Contour_Type right_of_right = children.right(1);
 
-        ssize_type offset = minimum_offset(right_contours[left_child], left_contours[right_child], width_map);
+        ssize_type offset = minimum_offset(right_of_left, left_of_right, width_map);
         offset += style.sibling_margin;
         ssize_type total_width = offset + width_map(right_child);
         ssize_type current_width = width_map(curr);
@@ -155,51 +112,48 @@ namespace trim
             break;
           }
         }
-        offsets[curr] = 0;
-        offsets[left_child] = offset1;
-        offsets[right_child] = offset2;
-
-        left_contours[curr] = std::move(left_contours[left_child]);
-        right_contours[curr] = std::move(right_contours[right_child]);
-
-        left_contours[curr][0].offset = offset1;
-        right_contours[curr][0].offset = offset2;
+        children.offset(0) = offset1;
+        children.offset(1) = offset2;
 
-        left_contours[curr].merge(std::move(left_contours[right_child]));
-        right_contours[curr].merge(std::move(right_contours[left_child]));
+        // the contours merged in keep the offsets they had before the children were placed
+        left_of_left.set_front_offset(offset1);
+        right_of_right.set_front_offset(offset2);
 
-        left_contours[curr].push_front(curr, 0);
-        right_contours[curr].push_front(curr, 0);
+        left_of_left.merge(std::move(left_of_right));
+        right_of_right.merge(std::move(right_of_left));
 
-        return;
+        left_of_left.push_front(curr, 0);
+        right_of_right.push_front(curr, 0);
+        return {std::move(left_of_left), std::move(right_of_right)};
       }
 
       // otherwise there are more than 2 children
 
-      size_type leftmost_child = tree.get_child(curr, 0);
-      size_type rightmost_child = tree.get_child(curr, num_children - 1);
-      Contour previous_right_contour = std::move(right_contours[leftmost_child]);
-      Contour previous_left_contour = std::move(left_contours[leftmost_child]);
+      // offsets are relative to the leftmost child until the children are aligned
+      children.offset(0) = 0;
+      Contour_Type previous_right_contour = children.right(0);
+      Contour_Type previous_left_contour = children.left(0);
       ssize_type total_width = 0;
 
       for(size_type i = 1; i < num_children; ++i) {
         size_type child = tree.get_child(curr, i);
-        size_type prev_child = tree.get_child(curr, i - 1);
-        left_contours[child][0].offset = offsets[prev_child];
-        right_contours[child][0].offset = offsets[prev_child];
+        ssize_type const previous_offset = children.offset(i - 1);
+        Contour_Type left_contour = children.left(i);
+        Contour_Type right_contour = children.right(i);
+        left_contour.set_front_offset(previous_offset);
 
-        ssize_type offset = minimum_offset(previous_right_contour, left_contours[child], width_map);
+        ssize_type offset = minimum_offset(previous_right_contour, left_contour, width_map);
         offset += style.sibling_margin;
 
-        right_contours[child][0].offset = offsets[prev_child] + offset;
-        left_contours[child][0].offset = offsets[prev_child] + offset;
+        right_contour.set_front_offset(previous_offset + offset);
+        left_contour.set_front_offset(previous_offset + offset);
 
-        right_contours[child].merge(std::move(previous_right_contour));
-        previous_left_contour.merge(std::move(left_contours[child]));
-        previous_right_contour = std::move(right_contours[child]);
+        right_contour.merge(std::move(previous_right_contour));
+        previous_left_contour.merge(std::move(left_contour));
+        previous_right_contour = std::move(right_contour);
 
-        offsets[child] = offsets[prev_child] + offset;
-        total_width = offsets[child] + width_map(child);
+        children.offset(i) = previous_offset + offset;
+        total_width = children.offset(i) + width_map(child);
       }
 
       switch(style.tree_align) {
@@ -208,57 +162,316 @@ namespace trim
           break;
         }
         case Tree_Alignment::CENTER: {
-          for(size_type i = 0; i < num_children; ++i) {
-            size_type child = tree.get_child(curr, i);
-            offsets[child] = offsets[child] - (total_width / 2) + (width_map(curr) / 2);
-          }
+          for(size_type i = 0; i < num_children; ++i)
+            children.offset(i) = children.offset(i) - (total_width / 2) + (width_map(curr) / 2);
           break;
         }
         case Tree_Alignment::RIGHT: {
-          for(size_type i = 0; i < num_children; ++i) {
-            size_type child = tree.get_child(curr, i);
-            offsets[child] = offsets[child] - (total_width) + (width_map(curr));
-          }
+          for(size_type i = 0; i < num_children; ++i)
+            children.offset(i) = children.offset(i) - (total_width) + (width_map(curr));
           break;
         }
       }
 
-      left_contours[curr] = std::move(previous_left_contour);
-      right_contours[curr] = std::move(previous_right_contour);
-      left_contours[curr][0].offset = offsets[leftmost_child];
-      right_contours[curr][0].offset = offsets[rightmost_child];
+      previous_left_contour.set_front_offset(children.offset(0));
+      previous_right_contour.set_front_offset(children.offset(num_children - 1));
 
-      left_contours[curr].push_front(curr, 0);
-      right_contours[curr].push_front(curr, 0);
-    });
+      previous_left_contour.push_front(curr, 0);
+      previous_right_contour.push_front(curr, 0);
+      return {std::move(previous_left_contour), std::move(previous_right_contour)};
+    }
 
-    // Use the computed offsets to compute the final layout
-    Point const root_top_left = Point(0, 0);
-    Point const root_bot_right = Point(node_height[root] - 1, node_width[root] - 1);
-    result[root] = Node_Layout(Rect(root_top_left, root_bot_right));
+    /*!
+     * Places the children of a node relative to it, from the contours of their subtrees.
+     * Nodes must be placed after their children, the placement of a node only reads the offsets
+     * and contours of its own subtree, so disjoint subtrees can be placed on different threads.
+     */
+    struct Contour_Placer
+    {
+      private:
+
+      Tree const& m_tree;
+      std::vector<ssize_type> const& m_widths;
+      Style const& m_style;
+      // offset of the left column of a node from the left column of its parent
+      std::vector<ssize_type> m_offsets {};
+      // the left and right contours of all the subtrees share a pool each, released with the placer
+      Contour_Pool m_left_pool {};
+      Contour_Pool m_right_pool {};
+      std::vector<Contour> m_left_contours {};
+      std::vector<Contour> m_right_contours {};
+
+      // the children of a node, whose contours are moved into the contours of the node
+      struct Children
+      {
+        Contour_Placer& placer;
+        size_type node {};
+
+        [[nodiscard]] constexpr Contour left(size_type index) const noexcept
+        {
+          return std::move(placer.m_left_contours[placer.m_tree.get_child(node, index)]);
+        }
 
-    trim::tree_visit_preorder(tree, root, [&](size_type curr) -> void {
-      ssize_type subtree_width = 0;
-      for(size_type i = 0; i < tree.num_children(curr); ++i) {
-        size_type child = tree.get_child(curr, i);
-        subtree_width = std::max(subtree_width, offsets[child] + node_width[child]);
+        [[nodiscard]] constexpr Contour right(size_type index) const noexcept
+        {
+          return std::move(placer.m_right_contours[placer.m_tree.get_child(node, index)]);
+        }
+
+        [[nodiscard]] constexpr ssize_type& offset(size_type index) const noexcept
+        {
+          return placer.m_offsets[placer.m_tree.get_child(node, index)];
+        }
+
+        [[nodiscard]] constexpr Contour empty_left() const noexcept
+        {
+          return Contour(placer.m_left_pool);
+        }
+
+        [[nodiscard]] constexpr Contour empty_right() const noexcept
+        {
+          return Contour(placer.m_right_pool);
+        }
+      };
+
+      public:
+
+      constexpr Contour_Placer(Tree const& tree, std::vector<ssize_type> const& widths, Style const& style)
+        : m_tree(tree)
+        , m_widths(widths)
+        , m_style(style)
+        , m_offsets(tree.size(), 0)
+        , m_left_pool(tree.size())
+        , m_right_pool(tree.size())
+        , m_left_contours(tree.size())
+        , m_right_contours(tree.size())
+      {}
+
+      // contours point into the pools of the placer
+      Contour_Placer(Contour_Placer const&) = delete;
+      Contour_Placer& operator=(Contour_Placer const&) = delete;
+
+      [[nodiscard]] constexpr std::vector<ssize_type> const& offsets() const noexcept
+      {
+        return m_offsets;
+      }
+
+      // makes room for nodes added to the tree since the placer was made
+      constexpr void resize(size_type num_nodes)
+      {
+        m_offsets.resize(num_nodes, 0);
+        m_left_pool.resize(num_nodes);
+        m_right_pool.resize(num_nodes);
+        m_left_contours.resize(num_nodes);
+        m_right_contours.resize(num_nodes);
       }
 
-      Rect const parent_rect = result[curr].rect;
-      coord_type const parent_left_column = left_column(parent_rect);
+      // records the changes the placements make to the contour elements, see Contour_Journal
+      constexpr void record_changes(Contour_Journal* journal) noexcept
+      {
+        m_left_pool.record_changes(journal);
+        m_right_pool.record_changes(journal);
+      }
 
-      for(size_type i = 0; i < tree.num_children(curr); ++i) {
-        size_type child = tree.get_child(curr, i);
-        coord_type const child_line = lines[child];
-        coord_type const child_left_column = parent_left_column + offsets[child];
-        coord_type const child_height = node_height[child];
-        coord_type const child_width = node_width[child];
-        Point const top_left = Point(child_line, child_left_column);
-        Point const bot_right = Point(child_line + child_height - 1, child_left_column + child_width - 1);
-        result[child] = Node_Layout(Rect(top_left, bot_right));
+      // where the contours of the subtree of a node are, after the node is placed and before its parent is
+      [[nodiscard]] constexpr std::pair<Contour::Span, Contour::Span> contour_spans(size_type node) const noexcept
+      {
+        return {m_left_contours[node].span(), m_right_contours[node].span()};
       }
-    });
 
-    return result;
+      // gives back the contours of a placed node to place its parent again
+      constexpr void restore_contours(size_type node, std::pair<Contour::Span, Contour::Span> spans) noexcept
+      {
+        m_left_contours[node] = Contour(m_left_pool, spans.first);
+        m_right_contours[node] = Contour(m_right_pool, spans.second);
+      }
+
+      constexpr void place(size_type curr)
+      {
+        Children children = Children {.placer = *this, .node = curr};
+        auto [left_contour, right_contour] = detail::place_children<Contour>(m_tree, m_widths, m_style, curr, children);
+        m_left_contours[curr] = std::move(left_contour);
+        m_right_contours[curr] = std::move(right_contour);
+      }
+    };
+
+    /*!
+     * Places the children of every class of subtrees once, as Contour_Placer places them.
+     * Contours are shared by all the subtrees of a class, so they are persistent.
+     */
+    struct Shape_Placer
+    {
+      private:
+
+      Tree const& m_tree;
+      Subtree_Shapes const& m_shapes;
+      std::vector<ssize_type> const& m_widths;
+      Style const& m_style;
+      Persistent_Contour_Pool m_pool {};
+      std::vector<Persistent_Contour> m_left_contours {};
+      std::vector<Persistent_Contour> m_right_contours {};
+      // offsets of the children of a class from the class root, in the layout of Subtree_Shapes::children
+      std::vector<ssize_type> m_offsets {};
+
+      // the children of a class, whose contours are shared with the contours of the class
+      struct Children
+      {
+        Shape_Placer& placer;
+        size_type shape {};
+
+        [[nodiscard]] constexpr size_type child_shape(size_type index) const noexcept
+        {
+          return placer.m_shapes.children[placer.m_shapes.children_begin[shape] + index];
+        }
+
+        [[nodiscard]] constexpr Persistent_Contour left(size_type index) const noexcept
+        {
+          return placer.m_left_contours[child_shape(index)];
+        }
+
+        [[nodiscard]] constexpr Persistent_Contour right(size_type index) const noexcept
+        {
+          return placer.m_right_contours[child_shape(index)];
+        }
+
+        [[nodiscard]] constexpr ssize_type& offset(size_type index) const noexcept
+        {
+          return placer.m_offsets[placer.m_shapes.children_begin[shape] + index];
+        }
+
+        [[nodiscard]] constexpr Persistent_Contour empty_left() const noexcept
+        {
+          return Persistent_Contour(placer.m_pool);
+        }
+
+        [[nodiscard]] constexpr Persistent_Contour empty_right() const noexcept
+        {
+          return Persistent_Contour(placer.m_pool);
+        }
+      };
+
+      public:
+
+      constexpr Shape_Placer(Tree const& tree, Subtree_Shapes const& shapes, std::vector<ssize_type> const& widths, Style const& style)
+        : m_tree(tree)
+        , m_shapes(shapes)
+        , m_widths(widths)
+        , m_style(style)
+        , m_pool()
+        , m_left_contours(shapes.size())
+        , m_right_contours(shapes.size())
+        , m_offsets(shapes.children.size(), 0)
+      {
+        // classes are numbered children first
+        for(size_type shape = 0; shape < shapes.size(); ++shape) {
+          Children children = Children {.placer = *this, .shape = shape};
+          auto [left_contour, right_contour] = detail::place_children<Persistent_Contour>(m_tree, m_widths, m_style, shapes.representatives[shape], children);
+          m_left_contours[shape] = left_contour;
+          m_right_contours[shape] = right_contour;
+        }
+      }
+
+      // contours point into the pool of the placer
+      Shape_Placer(Shape_Placer const&) = delete;
+      Shape_Placer& operator=(Shape_Placer const&) = delete;
+
+      // the offset of every node from its parent, as placed by Contour_Placer
+      [[nodiscard]] constexpr std::vector<ssize_type> node_offsets(Tree_Preorder const& order) const
+      {
+        std::vector<ssize_type> result = std::vector<ssize_type>(m_tree.size(), 0);
+        for(size_type node : order.nodes) {
+          ssize_type const* offsets = m_offsets.data() + m_shapes.children_begin[m_shapes.node_shapes[node]];
+          for(size_type index = 0; index < m_tree.num_children(node); ++index)
+            result[m_tree.get_child(node, index)] = offsets[index];
+        }
+        return result;
+      }
+    };
+
+    // the rects of the nodes from their offsets, the root is at the top left corner
+    [[nodiscard]] constexpr Tree_Layout layout_from_offsets(Tree const& tree, size_type root, Layout_Metrics const& metrics, std::vector<ssize_type> const& offsets)
+    {
+      std::vector<ssize_type> const& lines = metrics.lines;
+      std::vector<ssize_type> const& node_width = metrics.widths;
+      std::vector<ssize_type> const& node_height = metrics.heights;
+      Tree_Layout result = Tree_Layout(tree.size());
+
+      // Use the computed offsets to compute the final layout
+      Point const root_top_left = Point(0, 0);
+      Point const root_bot_right = Point(node_height[root] - 1, node_width[root] - 1);
+      result[root] = Node_Layout(Rect(root_top_left, root_bot_right));
+
+      trim::tree_visit_preorder(tree, root, [&](size_type curr) -> void {
+        ssize_type subtree_width = 0;
+        for(size_type i = 0; i < tree.num_children(curr); ++i) {
+          size_type child = tree.get_child(curr, i);
+          subtree_width = std::max(subtree_width, offsets[child] + node_width[child]);
+        }
+
+        Rect const parent_rect = result[curr].rect;
+        coord_type const parent_left_column = left_column(parent_rect);
+
+        for(size_type i = 0; i < tree.num_children(curr); ++i) {
+          size_type child = tree.get_child(curr, i);
+          coord_type const child_line = lines[child];
+          coord_type const child_left_column = parent_left_column + offsets[child];
+          coord_type const child_height = node_height[child];
+          coord_type const child_width = node_width[child];
+          Point const top_left = Point(child_line, child_left_column);
+          Point const bot_right = Point(child_line + child_height - 1, child_left_column + child_width - 1);
+          result[child] = Node_Layout(Rect(top_left, bot_right));
+        }
+      });
+
+      return result;
+    }
+
+    // classes pay for hashing the subtrees and copying their contours once they repeat this often
+    constexpr inline size_type min_nodes_per_shape = 8;
+  } // namespace detail
+
+  constexpr Tree_Layout make_layout(            //
+    Tree const& tree,                           //
+    size_type root,                             //
+    Labels const& node_labels,                  //
+    [[maybe_unused]] Labels const& edge_labels, //
+    Style const& style)
+  {
+    Layout_Metrics const metrics = trim::compute_layout_metrics(tree, root, node_labels, style);
+
+    // subtrees of the same shape and widths are placed once, if they repeat often enough to pay for their classes
+    std::optional<Subtree_Shapes> const shapes = trim::classify_subtrees(tree, metrics.order, metrics.widths, detail::min_nodes_per_shape);
+    if(shapes.has_value()) {
+      detail::Shape_Placer const placer = detail::Shape_Placer(tree, shapes.value(), metrics.widths, style);
+      return detail::layout_from_offsets(tree, root, metrics, placer.node_offsets(metrics.order));
+    }
+
+    // children come after their parent in preorder
+    detail::Contour_Placer placer = detail::Contour_Placer(tree, metrics.widths, style);
+    for(size_type i = metrics.order.size(); i-- > 0;)
+      placer.place(metrics.order.nodes[i]);
+
+    return detail::layout_from_offsets(tree, root, metrics, placer.offsets());
+  }
+
+  enum class Layout_Engine
+  {
+    // make_layout, merges a contour per subtree
+    CONTOUR = 0,
+    // make_walker_layout, linear time
+    WALKER = 1
+  };
+
+  // lays out the tree with the given engine
+  constexpr Tree_Layout make_layout(            //
+    Tree const& tree,                           //
+    size_type root,                             //
+    Labels const& node_labels,                  //
+    Labels const& edge_labels,                  //
+    Style const& style,                         //
+    Layout_Engine engine)
+  {
+    if(engine == Layout_Engine::WALKER)
+      return trim::make_walker_layout(tree, root, node_labels, edge_labels, style);
+    return trim::make_layout(tree, root, node_labels, edge_labels, style);
   }
 } // namespace trim
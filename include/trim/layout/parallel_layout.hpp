@@ -0,0 +1,117 @@
+#pragma once
+#include <trim/container/labels.hpp>
+#include <trim/container/tree.hpp>
+#include <trim/layout/layout_metrics.hpp>
+#include <trim/layout/make_layout.hpp>
+#include <trim/layout/subtree_shapes.hpp>
+#include <trim/layout/tree_layout.hpp>
+#include <trim/style/style.hpp>
+#include <trim/util/ints.hpp>
+#include <trim/util/task_pool.hpp>
+
+#include <atomic>
+#include <optional>
+#include <vector>
+
+namespace trim
+{
+  /*!
+   * Lays out a tree like make_layout, placing disjoint subtrees on several threads.
+   * Subtrees of at most max_task_nodes nodes are placed by a single task, runs of small sibling subtrees
+   * are grouped in the same task. The nodes above them are placed by the thread completing their last child,
+   * so a parent merges the contours of its children once all of them are placed.
+   * Trees whose subtrees repeat are placed once per shape as in make_layout, on the calling thread,
+   * only the contours of the other trees are merged in parallel.
+   * Every node is placed from the same contours as in make_layout, the layouts are identical.
+   */
+  inline Tree_Layout make_parallel_layout(      //
+    Tree const& tree,                           //
+    size_type root,                             //
+    Labels const& node_labels,                  //
+    Labels const& edge_labels,                  //
+    Style const& style,                         //
+    unsigned num_threads)
+  {
+    // nodes placed by a task, large enough for a task to outweigh its scheduling
+    static constexpr size_type max_task_nodes = 4096;
+
+    if(num_threads <= 1 || tree.size() <= max_task_nodes)
+      return trim::make_layout(tree, root, node_labels, edge_labels, style);
+
+    Layout_Metrics const metrics = trim::compute_layout_metrics(tree, root, node_labels, style);
+
+    // placing each shape once beats placing every node on several threads
+    std::optional<Subtree_Shapes> const shapes = trim::classify_subtrees(tree, metrics.order, metrics.widths, detail::min_nodes_per_shape);
+    if(shapes.has_value()) {
+      detail::Shape_Placer const placer = detail::Shape_Placer(tree, shapes.value(), metrics.widths, style);
+      return detail::layout_from_offsets(tree, root, metrics, placer.node_offsets(metrics.order));
+    }
+
+    Tree_Preorder const& order = metrics.order;
+    size_type const size = order.size();
+
+    // the subtree of the node at position i of the preorder is at positions [i, i + subtree_size[i])
+    std::vector<size_type> subtree_size = std::vector<size_type>(size, 1);
+    for(size_type i = size; i-- > 1;)
+      subtree_size[order.parents[i]] += subtree_size[i];
+
+    if(subtree_size[0] <= max_task_nodes)
+      return trim::make_layout(tree, root, node_labels, edge_labels, style);
+
+    // tasks are ranges of consecutive small subtrees whose parents are too large for a task
+    std::vector<size_type> task_begin {};
+    std::vector<size_type> task_nodes {};
+    size_type task_total = 0;
+    for(size_type i = 1; i < size; ++i) {
+      if(subtree_size[order.parents[i]] <= max_task_nodes || subtree_size[i] > max_task_nodes)
+        continue;
+
+      task_total += subtree_size[i];
+      bool const extends_task = !task_begin.empty() && task_begin.back() + task_nodes.back() == i && task_nodes.back() + subtree_size[i] <= max_task_nodes;
+      if(extends_task) {
+        task_nodes.back() += subtree_size[i];
+      } else {
+        task_begin.push_back(i);
+        task_nodes.push_back(subtree_size[i]);
+      }
+    }
+
+    detail::Contour_Placer placer = detail::Contour_Placer(tree, metrics.widths, style);
+
+    // most nodes are above the tasks and placed one after the other, as in a deep chain, threads only add overhead
+    if(task_total < size / 2) {
+      for(size_type i = size; i-- > 0;)
+        placer.place(order.nodes[i]);
+      return detail::layout_from_offsets(tree, root, metrics, placer.offsets());
+    }
+
+    // the parents above the tasks wait for as many completed children as they have
+    std::vector<std::atomic<size_type>> pending_children = std::vector<std::atomic<size_type>>(size);
+    for(size_type i = 0; i < size; ++i) {
+      if(subtree_size[i] > max_task_nodes)
+        pending_children[i].store(tree.num_children(order.nodes[i]), std::memory_order_relaxed);
+    }
+
+    // the last child to complete places its parent, and so on up the tree
+    auto const complete = [&](size_type position) -> void {
+      for(size_type parent = order.parents[position]; parent != Tree_Preorder::npos; parent = order.parents[parent]) {
+        if(pending_children[parent].fetch_sub(1, std::memory_order_acq_rel) != 1)
+          return;
+        placer.place(order.nodes[parent]);
+      }
+    };
+
+    Task_Pool(num_threads).run(task_nodes, [&](size_type task) -> void {
+      size_type const begin = task_begin[task];
+      size_type const end = begin + task_nodes[task];
+
+      // children come after their parent in preorder
+      for(size_type i = end; i-- > begin;)
+        placer.place(order.nodes[i]);
+      for(size_type i = begin; i < end; i += subtree_size[i])
+        complete(i);
+    });
+
+    return detail::layout_from_offsets(tree, root, metrics, placer.offsets());
+  }
+} // namespace trim
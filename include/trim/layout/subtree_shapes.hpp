@@ -0,0 +1,121 @@
+#pragma once
+#include <trim/container/tree.hpp>
+#include <trim/util/ints.hpp>
+#include <trim/util/splitmix64.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace trim
+{
+  /*!
+   * Subtrees sorted in classes of the same shape and node widths.
+   * The columns of the nodes of a subtree relative to its root only depend on its class,
+   * heights don't matter since nodes of a level share their lines.
+   * Classes are numbered children first, so the classes of the children of a node come before its own.
+   */
+  struct Subtree_Shapes
+  {
+    // the class of every node reachable from the root
+    std::vector<size_type> node_shapes {};
+    // a node of every class
+    std::vector<size_type> representatives {};
+    // the classes of the children of class c are children[children_begin[c], children_begin[c + 1])
+    std::vector<size_type> children_begin {};
+    std::vector<size_type> children {};
+
+    [[nodiscard]] constexpr size_type size() const noexcept
+    {
+      return representatives.size();
+    }
+  };
+
+  /*!
+   * Sorts the subtrees of the preorder of a tree in classes, in a single pass over the nodes.
+   * Classes are kept in an open addressing table keyed by a hash of the width and the classes of the children,
+   * the table grows with the number of classes so a tree of few classes is sorted within the cache.
+   * Sorting gives up and returns nothing as soon as the nodes sorted so far, past the first few thousand,
+   * average fewer than min_nodes_per_shape nodes a class: the classes of such a tree would cost more than they save.
+   */
+  [[nodiscard]] constexpr std::optional<Subtree_Shapes> classify_subtrees( //
+    Tree const& tree,                                                    //
+    Tree_Preorder const& order,                                          //
+    std::vector<ssize_type> const& widths,                               //
+    size_type min_nodes_per_shape = 1)
+  {
+    constexpr size_type empty_slot = static_cast<size_type>(-1);
+    // classes found before the repeats are counted, the subtrees of the first nodes rarely repeat yet
+    constexpr size_type free_shapes = 4096;
+
+    struct Slot
+    {
+      std::uint_least64_t hash {};
+      size_type shape = empty_slot;
+    };
+
+    Subtree_Shapes result {};
+    result.node_shapes = std::vector<size_type>(tree.size(), 0);
+    result.children_begin.push_back(0);
+
+    // kept at most half full
+    std::vector<Slot> slots = std::vector<Slot>(16);
+    std::vector<size_type> key {};
+
+    auto const find_slot = [&slots](std::uint_least64_t hash, auto const& is_shape) -> Slot& {
+      size_type const mask = slots.size() - 1;
+      for(size_type slot = static_cast<size_type>(hash) & mask;; slot = (slot + 1) & mask) {
+        if(slots[slot].shape == empty_slot || (slots[slot].hash == hash && is_shape(slots[slot].shape)))
+          return slots[slot];
+      }
+    };
+
+    // children come after their parent in preorder
+    for(size_type i = order.size(); i-- > 0;) {
+      size_type const node = order.nodes[i];
+
+      key.clear();
+      std::uint_least64_t hash = trim::splitmix64(static_cast<std::uint_least64_t>(widths[node]));
+      for(size_type index = 0; index < tree.num_children(node); ++index) {
+        size_type const shape = result.node_shapes[tree.get_child(node, index)];
+        key.push_back(shape);
+        hash = trim::splitmix64(hash ^ shape);
+      }
+
+      Slot& slot = find_slot(hash, [&](size_type shape) -> bool {
+        std::span<size_type const> const children = std::span(result.children).subspan(result.children_begin[shape], result.children_begin[shape + 1] - result.children_begin[shape]);
+        return widths[result.representatives[shape]] == widths[node] && std::ranges::equal(key, children);
+      });
+
+      if(slot.shape != empty_slot) {
+        result.node_shapes[node] = slot.shape;
+        continue;
+      }
+
+      size_type const shape = result.size();
+      slot = Slot {.hash = hash, .shape = shape};
+      result.node_shapes[node] = shape;
+      result.representatives.push_back(node);
+      result.children.insert(result.children.end(), key.begin(), key.end());
+      result.children_begin.push_back(result.children.size());
+
+      size_type const num_nodes = order.size() - i;
+      if(result.size() > free_shapes && (result.size() - free_shapes) * min_nodes_per_shape > num_nodes)
+        return std::nullopt;
+
+      // the classes are all different, they are moved without being compared
+      if(2 * result.size() > slots.size()) {
+        std::vector<Slot> old_slots = std::exchange(slots, std::vector<Slot>(2 * slots.size()));
+        for(Slot const& old_slot : old_slots) {
+          if(old_slot.shape != empty_slot)
+            find_slot(old_slot.hash, [](size_type) { return false; }) = old_slot;
+        }
+      }
+    }
+
+    return result;
+  }
+} // namespace trim
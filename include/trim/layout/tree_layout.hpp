@@ -67,6 +67,20 @@ namespace trim
       return layout[index];
     }
 
+    /*!
+     * The bounding box of all the node rects.
+     * Branches run between nodes, so this is also the rect of the drawn tree.
+     */
+    [[nodiscard]] constexpr Rect rect() const noexcept
+    {
+      TRIM_ASSERT(size() > 0);
+      Rect result = layout[0].rect;
+      for(value_type const& node : layout) {
+        result = trim::minumum_bounding_box(result, node.rect);
+      }
+      return result;
+    }
+
     template<typename Stream>
     friend constexpr Stream& operator<<(Stream& stream, Tree_Layout const& tree)
     {
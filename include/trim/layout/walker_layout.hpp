@@ -0,0 +1,286 @@
+#pragma once
+#include <trim/container/labels.hpp>
+#include <trim/container/tree.hpp>
+#include <trim/layout/layout_metrics.hpp>
+#include <trim/layout/tree_layout.hpp>
+#include <trim/style/style.hpp>
+#include <trim/util/geometry.hpp>
+#include <trim/util/ints.hpp>
+
+#include <vector>
+
+namespace trim
+{
+  namespace detail
+  {
+    /*!
+     * Walker's algorithm in the linear time formulation of Buchheim, Jünger and Leipert.
+     * Positions are the left columns of the nodes. Nodes of a level share their lines,
+     * so the contours of two subtrees are compared level by level: the left contour is followed
+     * through the first child or the thread of a node, the right contour through its last child or thread.
+     * Shifts of a subtree are stored in mod and only applied by the final preorder pass,
+     * the shifts spread over the siblings between two moved subtrees are applied once per parent.
+     */
+    struct Walker
+    {
+      private:
+
+      static constexpr size_type npos = Tree_Preorder::npos;
+
+      ssize_type m_margin {};
+      Tree_Alignment m_align {};
+
+      // nodes are numbered in preorder, so passes over the arrays run in memory order
+      std::vector<size_type> m_parent {};
+      std::vector<size_type> m_child_begin {};
+      std::vector<size_type> m_children {};
+      std::vector<ssize_type> m_width {};
+      // index of a node among the children of its parent
+      std::vector<size_type> m_number {};
+      std::vector<ssize_type> m_prelim {};
+      std::vector<ssize_type> m_mod {};
+      std::vector<ssize_type> m_shift {};
+      std::vector<ssize_type> m_change {};
+      std::vector<size_type> m_thread {};
+      std::vector<size_type> m_ancestor {};
+
+      public:
+
+      constexpr Walker(Tree_Preorder const& order, std::vector<ssize_type> const& widths, Style const& style)
+        : m_margin(style.sibling_margin)
+        , m_align(style.tree_align)
+        , m_parent(order.parents)
+        , m_child_begin(order.size() + 1, 0)
+        , m_children(order.size() > 0 ? order.size() - 1 : 0)
+        , m_width(order.size(), 0)
+        , m_number(order.size(), 0)
+        , m_prelim(order.size(), 0)
+        , m_mod(order.size(), 0)
+        , m_shift(order.size(), 0)
+        , m_change(order.size(), 0)
+        , m_thread(order.size(), npos)
+        , m_ancestor(order.size(), 0)
+      {
+        size_type const size = order.size();
+        for(size_type node = 0; node < size; ++node) {
+          m_width[node] = widths[order.nodes[node]];
+          m_ancestor[node] = node;
+        }
+
+        // children are listed in the order they were visited, which is the order of the tree
+        for(size_type node = 1; node < size; ++node)
+          m_child_begin[m_parent[node] + 1] += 1;
+        for(size_type node = 0; node < size; ++node)
+          m_child_begin[node + 1] += m_child_begin[node];
+
+        std::vector<size_type> filled = std::vector<size_type>(m_child_begin.begin(), m_child_begin.end() - 1);
+        for(size_type node = 1; node < size; ++node) {
+          size_type const parent = m_parent[node];
+          m_number[node] = filled[parent] - m_child_begin[parent];
+          m_children[filled[parent]++] = node;
+        }
+      }
+
+      // the left column of every node in preorder, the root is at column 0
+      [[nodiscard]] constexpr std::vector<ssize_type> columns()
+      {
+        size_type const size = m_parent.size();
+
+        // children come after their parent in preorder
+        for(size_type node = size; node-- > 0;)
+          first_walk(node);
+
+        // the mods of the ancestors of a node add up to its shift
+        std::vector<ssize_type> result = std::vector<ssize_type>(size, 0);
+        std::vector<ssize_type> ancestor_mods = std::vector<ssize_type>(size, 0);
+        for(size_type node = 1; node < size; ++node)
+          ancestor_mods[node] = ancestor_mods[m_parent[node]] + m_mod[m_parent[node]];
+        for(size_type node = 0; node < size; ++node)
+          result[node] = m_prelim[node] + ancestor_mods[node] - m_prelim[0];
+        return result;
+      }
+
+      private:
+
+      [[nodiscard]] constexpr size_type num_children(size_type node) const noexcept
+      {
+        return m_child_begin[node + 1] - m_child_begin[node];
+      }
+
+      [[nodiscard]] constexpr size_type child(size_type node, size_type index) const noexcept
+      {
+        return m_children[m_child_begin[node] + index];
+      }
+
+      [[nodiscard]] constexpr size_type next_left(size_type node) const noexcept
+      {
+        return num_children(node) > 0 ? child(node, 0) : m_thread[node];
+      }
+
+      [[nodiscard]] constexpr size_type next_right(size_type node) const noexcept
+      {
+        return num_children(node) > 0 ? child(node, num_children(node) - 1) : m_thread[node];
+      }
+
+      // children are visited before their parent, each node is placed relative to its own subtree
+      constexpr void first_walk(size_type node)
+      {
+        size_type const count = num_children(node);
+        if(count == 0)
+          return;
+
+        // the children are put side by side, then their subtrees are pushed apart where they overlap
+        size_type default_ancestor = child(node, 0);
+        for(size_type i = 1; i < count; ++i) {
+          size_type const current = child(node, i);
+          size_type const left = child(node, i - 1);
+          ssize_type const placement = m_prelim[current];
+          m_prelim[current] = m_prelim[left] + m_width[left] + m_margin;
+          m_mod[current] = m_prelim[current] - placement;
+          apportion(node, current, default_ancestor);
+        }
+
+        execute_shifts(node);
+        m_prelim[node] = parent_column(node);
+      }
+
+      // the column of a parent above its placed children
+      [[nodiscard]] constexpr ssize_type parent_column(size_type node) const noexcept
+      {
+        size_type const first = child(node, 0);
+        size_type const last = child(node, num_children(node) - 1);
+
+        switch(m_align) {
+          case Tree_Alignment::NONE:
+          case Tree_Alignment::LEFT: {
+            return m_prelim[first];
+          }
+          case Tree_Alignment::CENTER: {
+            // the middle of the first and last child, widths are odd so every node has a middle column
+            ssize_type const sum = (m_prelim[first] + (m_width[first] - 1) / 2) + (m_prelim[last] + (m_width[last] - 1) / 2);
+            ssize_type const middle = sum >= 0 ? sum / 2 : -((1 - sum) / 2);
+            return middle - (m_width[node] - 1) / 2;
+          }
+          case Tree_Alignment::RIGHT: {
+            return m_prelim[last] + m_width[last] - m_width[node];
+          }
+        }
+        return m_prelim[first];
+      }
+
+      // pushes the subtree of node to the right of the subtrees of its left siblings
+      constexpr void apportion(size_type parent, size_type node, size_type& default_ancestor)
+      {
+        // inner and outer contours, on the side of node (p) and of its left siblings (m)
+        size_type inner_p = node;
+        size_type outer_p = node;
+        size_type inner_m = child(parent, m_number[node] - 1);
+        size_type outer_m = child(parent, 0);
+        ssize_type sum_inner_p = m_mod[inner_p];
+        ssize_type sum_outer_p = m_mod[outer_p];
+        ssize_type sum_inner_m = m_mod[inner_m];
+        ssize_type sum_outer_m = m_mod[outer_m];
+
+        while(next_right(inner_m) != npos && next_left(inner_p) != npos) {
+          inner_m = next_right(inner_m);
+          inner_p = next_left(inner_p);
+          outer_m = next_left(outer_m);
+          outer_p = next_right(outer_p);
+          m_ancestor[outer_p] = node;
+
+          ssize_type const shift = (m_prelim[inner_m] + sum_inner_m) + m_width[inner_m] + m_margin - (m_prelim[inner_p] + sum_inner_p);
+          if(shift > 0) {
+            move_subtree(parent, ancestor(inner_m, node, default_ancestor), node, shift);
+            sum_inner_p += shift;
+            sum_outer_p += shift;
+          }
+
+          sum_inner_m += m_mod[inner_m];
+          sum_inner_p += m_mod[inner_p];
+          sum_outer_m += m_mod[outer_m];
+          sum_outer_p += m_mod[outer_p];
+        }
+
+        // the shorter side continues along the contour of the taller one
+        if(next_right(inner_m) != npos && next_right(outer_p) == npos) {
+          m_thread[outer_p] = next_right(inner_m);
+          m_mod[outer_p] += sum_inner_m - sum_outer_p;
+        }
+
+        if(next_left(inner_p) != npos && next_left(outer_m) == npos) {
+          m_thread[outer_m] = next_left(inner_p);
+          m_mod[outer_m] += sum_inner_p - sum_outer_m;
+          default_ancestor = node;
+        }
+      }
+
+      // the sibling of node whose subtree holds contour_node, or the default ancestor
+      [[nodiscard]] constexpr size_type ancestor(size_type contour_node, size_type node, size_type default_ancestor) const noexcept
+      {
+        size_type const candidate = m_ancestor[contour_node];
+        return m_parent[candidate] == m_parent[node] ? candidate : default_ancestor;
+      }
+
+      /*!
+       * Moves the subtree of right by shift, and the siblings between left and right by an even share of it.
+       * Shares are whole columns: the remainder of the division goes to the sibling after left,
+       * so the shares still grow from left to right and no gap becomes narrower.
+       */
+      constexpr void move_subtree(size_type parent, size_type left, size_type right, ssize_type shift)
+      {
+        ssize_type const subtrees = static_cast<ssize_type>(m_number[right] - m_number[left]);
+        ssize_type const share = shift / subtrees;
+        ssize_type const remainder = shift - share * subtrees;
+
+        m_change[right] -= share;
+        m_shift[right] += shift;
+        m_change[left] += share;
+        m_prelim[right] += shift;
+        m_mod[right] += shift;
+        if(remainder != 0)
+          m_shift[child(parent, m_number[left] + 1)] -= remainder;
+      }
+
+      // applies the shares of the moves to the children of node, from right to left
+      constexpr void execute_shifts(size_type node)
+      {
+        ssize_type shift = 0;
+        ssize_type change = 0;
+        for(size_type i = num_children(node); i-- > 0;) {
+          size_type const current = child(node, i);
+          m_prelim[current] += shift;
+          m_mod[current] += shift;
+          change += m_change[current];
+          shift += m_shift[current] + change;
+        }
+      }
+    };
+  } // namespace detail
+
+  /*!
+   * Lays out a tree with Walker's algorithm, in time linear in the number of nodes.
+   * Unlike make_layout, no contour is stored per subtree: the contours are followed through threads.
+   * A parent is centered on its first and last child for Tree_Alignment::CENTER,
+   * and aligned with the left or right edge of its children for the other modes.
+   */
+  constexpr Tree_Layout make_walker_layout(     //
+    Tree const& tree,                           //
+    size_type root,                             //
+    Labels const& node_labels,                  //
+    [[maybe_unused]] Labels const& edge_labels, //
+    Style const& style)
+  {
+    Layout_Metrics const metrics = trim::compute_layout_metrics(tree, root, node_labels, style);
+    Tree_Preorder const& order = metrics.order;
+    std::vector<ssize_type> const columns = detail::Walker(order, metrics.widths, style).columns();
+
+    Tree_Layout result = Tree_Layout(tree.size());
+    for(size_type i = 0; i < order.size(); ++i) {
+      size_type const node = order.nodes[i];
+      Point const top_left = Point(metrics.lines[node], columns[i]);
+      Point const bot_right = Point(metrics.lines[node] + metrics.heights[node] - 1, columns[i] + metrics.widths[node] - 1);
+      result[node] = Node_Layout(Rect(top_left, bot_right));
+    }
+    return result;
+  }
+} // namespace trim
@@ -0,0 +1,60 @@
+#pragma once
+#include <trim/color/depth.hpp>
+
+#include <cstdlib>
+#include <string_view>
+
+#if defined(_WIN32)
+#  include <io.h>
+#else
+#  include <unistd.h>
+#endif
+
+namespace trim::port
+{
+  // returns true if the file descriptor is connected to a terminal
+  [[nodiscard]] inline bool is_terminal(int fd) noexcept
+  {
+#if defined(_WIN32)
+    return ::_isatty(fd) != 0;
+#else
+    return ::isatty(fd) != 0;
+#endif
+  }
+
+  /*!
+   * Guesses the color depth of the terminal behind a file descriptor.
+   * Output that is not a terminal, NO_COLOR and dumb terminals get no colors,
+   * COLORTERM=truecolor|24bit gets 24-bit colors, otherwise TERM decides between 256 and 16 colors.
+   */
+  [[nodiscard]] inline Color_Depth detect_color_depth(int fd) noexcept
+  {
+    auto const get_env = [](char const* name) noexcept -> std::string_view {
+      char const* value = std::getenv(name);
+      return value ? std::string_view(value) : std::string_view();
+    };
+
+    if(!is_terminal(fd) || !get_env("NO_COLOR").empty())
+      return Color_Depth::NONE;
+
+    std::string_view const colorterm = get_env("COLORTERM");
+    if(colorterm == "truecolor" || colorterm == "24bit")
+      return Color_Depth::TRUECOLOR;
+
+    std::string_view const term = get_env("TERM");
+    if(term.find("direct") != term.npos || term.find("truecolor") != term.npos)
+      return Color_Depth::TRUECOLOR;
+    if(term.find("256color") != term.npos)
+      return Color_Depth::ANSI_256;
+
+#if defined(_WIN32)
+    // the Windows console has no TERM but understands escape sequences
+    if(term.empty())
+      return Color_Depth::ANSI_16;
+#endif
+
+    if(term.empty() || term == "dumb")
+      return Color_Depth::NONE;
+    return Color_Depth::ANSI_16;
+  }
+} // namespace trim::port
@@ -0,0 +1,38 @@
+#pragma once
+#include <cerrno>
+#include <cstddef>
+
+#if defined(_WIN32)
+#  include <io.h>
+#else
+#  include <unistd.h>
+#endif
+
+namespace trim::port
+{
+  /*!
+   * Writes all the bytes to a file descriptor, retrying partial and interrupted writes.
+   * Returns false if the descriptor reports an error.
+   */
+  [[nodiscard]] inline bool write_all(int fd, char const* data, std::size_t size) noexcept
+  {
+    while(size > 0) {
+#if defined(_WIN32)
+      unsigned const chunk = size > 0x7FFFFFFF ? 0x7FFFFFFF : static_cast<unsigned>(size);
+      int const written = ::_write(fd, data, chunk);
+#else
+      auto const written = ::write(fd, data, size);
+#endif
+      if(written < 0) {
+        if(errno == EINTR)
+          continue;
+        return false;
+      }
+
+      data += written;
+      size -= static_cast<std::size_t>(written);
+    }
+
+    return true;
+  }
+} // namespace trim::port
@@ -0,0 +1,132 @@
+#pragma once
+#include <trim/color/depth.hpp>
+#include <trim/color/rgb.hpp>
+#include <trim/render/row_encoder.hpp>
+#include <trim/util/assert.hpp>
+#include <trim/util/format_int.hpp>
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <string_view>
+
+namespace trim
+{
+  // resets all graphic attributes
+  constexpr inline std::string_view ansi_reset = "\033[0m";
+
+  // the longest escape sequence written by format_ansi_foreground
+  constexpr inline std::size_t ansi_foreground_max_size = std::string_view("\033[38;2;255;255;255m").size();
+
+  /*!
+   * Writes the SGR escape sequence selecting a foreground color at the given depth.
+   * Color_RGB::NONE selects the default color, nothing is written for Color_Depth::NONE.
+   */
+  constexpr char* format_ansi_foreground(char* out, Color_RGB color, Color_Depth depth = Color_Depth::TRUECOLOR) noexcept
+  {
+    if(depth == Color_Depth::NONE)
+      return out;
+
+    if(color == Color_RGB::NONE)
+      return std::ranges::copy(ansi_reset, out).out;
+
+    switch(depth) {
+      case Color_Depth::NONE: {
+        return out;
+      }
+
+      case Color_Depth::ANSI_16: {
+        int const index = trim::nearest_ansi_16(color);
+        out = std::ranges::copy(std::string_view("\033["), out).out;
+        out = trim::format_integer(out, static_cast<unsigned>(index < 8 ? 30 + index : 90 + index - 8));
+        *out++ = 'm';
+        return out;
+      }
+
+      case Color_Depth::ANSI_256: {
+        out = std::ranges::copy(std::string_view("\033[38;5;"), out).out;
+        out = trim::format_integer(out, static_cast<unsigned>(trim::nearest_ansi_256(color)));
+        *out++ = 'm';
+        return out;
+      }
+
+      case Color_Depth::TRUECOLOR: {
+        out = std::ranges::copy(std::string_view("\033[38;2;"), out).out;
+        out = trim::format_integer(out, static_cast<unsigned>(color.red));
+        *out++ = ';';
+        out = trim::format_integer(out, static_cast<unsigned>(color.green));
+        *out++ = ';';
+        out = trim::format_integer(out, static_cast<unsigned>(color.blue));
+        *out++ = 'm';
+        return out;
+      }
+    }
+
+    TRIM_ASSERT(false);
+  }
+
+  /*!
+   * Options of the ANSI row encoder.
+   * The default writes every row padded with spaces to the full width, with 24-bit colors.
+   */
+  struct Ansi_Options
+  {
+    // drop the blanks after the last visible glyph of a row
+    bool trim_trailing_blanks = false;
+
+    // write interior runs of at least this many blanks as a cursor forward sequence (ESC[nC), 0 disables it
+    // the skipped cells are not cleared, so this is meant for output to a terminal
+    coord_type cursor_forward_min_blanks = 0;
+
+    // colors are approximated by the closest color available at this depth
+    Color_Depth color_depth = Color_Depth::TRUECOLOR;
+  };
+
+  /*!
+   * Marks up colors with ANSI escape sequences, see Row_Encoder.
+   * A run of a color begins with the escape sequence of the color, the default color is selected with a reset.
+   */
+  struct Ansi_Markup
+  {
+    static constexpr bool escapes_glyphs = false;
+
+    private:
+
+    Ansi_Options m_options {};
+
+    public:
+
+    Ansi_Markup() = default;
+
+    explicit constexpr Ansi_Markup(Ansi_Options const& options) noexcept
+      : m_options(options)
+    {}
+
+    [[nodiscard]] constexpr bool trim_trailing_blanks() const noexcept
+    {
+      return m_options.trim_trailing_blanks;
+    }
+
+    [[nodiscard]] constexpr coord_type cursor_forward_min_blanks() const noexcept
+    {
+      return m_options.cursor_forward_min_blanks;
+    }
+
+    constexpr void format_color(std::string& begin, [[maybe_unused]] std::string& end, Color_RGB color) const
+    {
+      std::array<char, ansi_foreground_max_size> buffer {};
+      char* const last = trim::format_ansi_foreground(buffer.data(), color, m_options.color_depth);
+      begin.assign(buffer.data(), last);
+    }
+
+    constexpr void format_glyph(std::string& out, std::string_view glyph) const
+    {
+      out.assign(glyph);
+    }
+  };
+
+  static_assert(Is_Row_Markup<Ansi_Markup>);
+
+  // encodes rows of a canvas as text with ANSI escape sequences
+  using Ansi_Encoder = Row_Encoder<Ansi_Markup>;
+} // namespace trim
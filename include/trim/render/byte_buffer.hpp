@@ -0,0 +1,67 @@
+#pragma once
+#include <trim/util/ints.hpp>
+
+#include <algorithm>
+#include <concepts>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace trim
+{
+  /*!
+   * Counts the bytes written into it instead of storing them.
+   * Encoders run with a Byte_Count compute the exact size of their output,
+   * so that the output can then be allocated once.
+   */
+  struct Byte_Count
+  {
+    size_type size = 0;
+  };
+
+  /*!
+   * What row encoders write into: a vector of bytes, a string, or a Byte_Count.
+   */
+  template<typename T>
+  concept Is_Byte_Buffer = std::same_as<T, std::vector<char>> || std::same_as<T, std::string> || std::same_as<T, Byte_Count>;
+
+  template<Is_Byte_Buffer Buffer>
+  constexpr void append_bytes(Buffer& out, std::string_view bytes)
+  {
+    if constexpr(std::same_as<Buffer, Byte_Count>) {
+      out.size += bytes.size();
+    } else {
+      out.insert(out.end(), bytes.begin(), bytes.end());
+    }
+  }
+
+  template<Is_Byte_Buffer Buffer>
+  constexpr void append_fill(Buffer& out, size_type count, char byte)
+  {
+    if constexpr(std::same_as<Buffer, Byte_Count>) {
+      out.size += count;
+    } else {
+      out.insert(out.end(), count, byte);
+    }
+  }
+
+  template<Is_Byte_Buffer Buffer>
+  constexpr void append_byte(Buffer& out, char byte)
+  {
+    append_fill(out, 1, byte);
+  }
+
+  // appends one byte per element of the range, computed by projection
+  template<Is_Byte_Buffer Buffer, std::ranges::sized_range Range, typename Projection>
+  constexpr void append_transformed(Buffer& out, Range const& range, Projection projection)
+  {
+    if constexpr(std::same_as<Buffer, Byte_Count>) {
+      out.size += std::ranges::size(range);
+    } else {
+      size_type const begin = out.size();
+      out.resize(begin + std::ranges::size(range));
+      std::ranges::transform(range, out.begin() + static_cast<ssize_type>(begin), projection);
+    }
+  }
+} // namespace trim
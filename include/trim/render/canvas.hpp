@@ -0,0 +1,226 @@
+#pragma once
+#include <trim/color/rgb.hpp>
+#include <trim/render/cell.hpp>
+#include <trim/render/glyph_table.hpp>
+#include <trim/render/palette.hpp>
+#include <trim/render/stamp.hpp>
+#include <trim/sprite/draw_result.hpp>
+#include <trim/style/style.hpp>
+#include <trim/util/assert.hpp>
+#include <trim/util/geometry.hpp>
+#include <trim/util/ints.hpp>
+
+#include <concepts>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace trim
+{
+  /*!
+   * A surface sprites can rasterize into.
+   * Painting an empty Draw_Result or a point outside rect() must do nothing.
+   */
+  template<typename T>
+  concept Is_Canvas = requires(T& canvas, Point point, Draw_Result drawable) {
+    // clang-format off
+    { canvas.rect() } -> std::same_as<Rect>;
+    { canvas.paint(point, drawable) };
+    // clang-format on
+  };
+
+  /*!
+   * A dense grid of cells covering a rectangle of the scene.
+   * Sprites rasterize themselves into a canvas, each sprite visiting only its own cells.
+   * Painting a cell overwrites the previous value, so painting sprites in order
+   * reproduces the 'last non-empty wins' rule of Composite_Sprite::draw.
+   * Cells outside the canvas rect are ignored, so a canvas can act as a clip window.
+   * Glyphs and colors are interned when painted, their bytes are only looked up by the encoder.
+   */
+  struct Canvas
+  {
+    private:
+
+    Rect m_rect {};
+    coord_type m_width {};
+    std::vector<Cell> m_cells {};
+    Glyph_Table m_glyphs {};
+    Palette m_palette {};
+    Stamp_Cache m_stamps {};
+
+    public:
+
+    Canvas() = default;
+
+    explicit constexpr Canvas(Rect rect)
+      : m_rect()
+      , m_width()
+      , m_cells()
+      , m_glyphs()
+      , m_palette()
+      , m_stamps()
+    {
+      reset(rect);
+    }
+
+    /*!
+     * Moves the canvas to another rect and clears all the cells.
+     * Interned glyphs, colors and stamps are kept, so a canvas can be reused row after row.
+     */
+    constexpr void reset(Rect rect)
+    {
+      m_rect = Rect(trim::top_left_corner(rect), trim::bot_right_corner(rect));
+      m_width = trim::width(m_rect) + 1;
+      m_cells.assign(static_cast<size_type>((trim::height(m_rect) + 1) * m_width), Cell {});
+    }
+
+    [[nodiscard]] constexpr Rect rect() const noexcept
+    {
+      return m_rect;
+    }
+
+    [[nodiscard]] constexpr bool contains(Point point) const noexcept
+    {
+      return trim::envelopes(m_rect, point);
+    }
+
+    [[nodiscard]] constexpr Draw_Result operator[](Point point) const noexcept
+    {
+      TRIM_ASSERT(contains(point));
+      Cell const cell = m_cells[index(point)];
+      return Draw_Result(m_glyphs.bytes(cell.glyph), m_palette[cell.color]);
+    }
+
+    [[nodiscard]] constexpr std::span<Cell const> row(coord_type line) const noexcept
+    {
+      TRIM_ASSERT(line >= top_line(m_rect) && line <= bot_line(m_rect));
+      size_type const begin = index(Point(line, left_column(m_rect)));
+      return std::span<Cell const>(m_cells.data() + begin, static_cast<size_type>(m_width));
+    }
+
+    [[nodiscard]] constexpr Glyph_Table const& glyph_table() const noexcept
+    {
+      return m_glyphs;
+    }
+
+    [[nodiscard]] constexpr Palette const& palette() const noexcept
+    {
+      return m_palette;
+    }
+
+    constexpr void paint(Point point, Draw_Result drawable)
+    {
+      if(drawable.empty() || !contains(point))
+        return;
+      m_cells[index(point)] = Cell {.glyph = m_glyphs.intern(drawable.character), .color = m_palette.intern(drawable.color)};
+    }
+
+    // the style stamps are rendered with, set before each raster pass
+    constexpr void set_style(Style const& style)
+    {
+      m_stamps.set_style(style);
+    }
+
+    // the stamp of a key, rendered by render(Stamp_Recorder&) the first time the key is seen
+    template<typename Render>
+    [[nodiscard]] constexpr Stamp const& stamp(std::uint64_t key, Rect rect, Render&& render)
+    {
+      return m_stamps.find(key, rect, m_glyphs, m_palette, std::forward<Render>(render));
+    }
+
+    // paints the cells of a stamp translated by origin, without interning them again
+    constexpr void paint(Point origin, Stamp const& stamp)
+    {
+      Rect const rect = trim::translate(stamp.rect(), origin.line, origin.column);
+      if(!trim::intersects(rect, m_rect))
+        return;
+
+      Rect const clip = trim::intersection(rect, m_rect);
+      for(coord_type line = top_line(clip); line <= bot_line(clip); ++line) {
+        Cell* const row = m_cells.data() + index(Point(line, left_column(m_rect)));
+        for(Stamp::Entry const& entry : stamp.line(line - origin.line)) {
+          coord_type const column = origin.column + entry.column;
+          if(column >= left_column(clip) && column <= right_column(clip))
+            row[column - left_column(m_rect)] = entry.cell;
+        }
+      }
+    }
+
+    private:
+
+    [[nodiscard]] constexpr size_type index(Point point) const noexcept
+    {
+      coord_type const line = point.line - top_line(m_rect);
+      coord_type const column = point.column - left_column(m_rect);
+      return static_cast<size_type>(line * m_width + column);
+    }
+  };
+
+  static_assert(Is_Canvas<Canvas>);
+
+  /*!
+   * A canvas that caches stamps, see Stamp_Cache.
+   * Sprites painted many times with the same shape render a stamp once and paint it at each origin.
+   */
+  template<typename T>
+  concept Is_Stamp_Canvas = Is_Canvas<T> && requires(T& canvas, Point origin, Stamp const& stamp) {
+    // clang-format off
+    { canvas.paint(origin, stamp) };
+    // clang-format on
+  };
+
+  static_assert(Is_Stamp_Canvas<Canvas>);
+
+  /*!
+   * Forwards the cells painted into it to another canvas, with their color replaced.
+   * The rainbow style paints a whole sprite in a single color this way.
+   */
+  template<Is_Canvas Target>
+  struct Tinted_Canvas
+  {
+    private:
+
+    Target* m_canvas {};
+    Color_RGB m_color {};
+
+    public:
+
+    constexpr Tinted_Canvas(Target& canvas, Color_RGB color) noexcept
+      : m_canvas(&canvas)
+      , m_color(color)
+    {}
+
+    [[nodiscard]] constexpr Rect rect() const noexcept
+    {
+      return m_canvas->rect();
+    }
+
+    constexpr void paint(Point point, Draw_Result drawable)
+    {
+      drawable.color = m_color;
+      m_canvas->paint(point, drawable);
+    }
+  };
+
+  static_assert(Is_Canvas<Tinted_Canvas<Canvas>>);
+
+  /*!
+   * Rasterizes a sprite by querying every cell of its rect that falls inside the canvas.
+   * Used for primitive sprites, which only cover a handful of cells.
+   */
+  template<typename T, Is_Canvas Target>
+  constexpr void raster_cells(T const& sprite, Style const& style, Target& canvas, Point origin) noexcept
+  {
+    Rect const rect = trim::translate(sprite.rect(), origin.line, origin.column);
+    if(!trim::intersects(rect, canvas.rect()))
+      return;
+
+    Rect const clip = trim::intersection(rect, canvas.rect());
+    for(coord_type line = top_line(clip); line <= bot_line(clip); ++line) {
+      for(coord_type column = left_column(clip); column <= right_column(clip); ++column) {
+        canvas.paint(Point(line, column), sprite.draw(style, Point(line - origin.line, column - origin.column)));
+      }
+    }
+  }
+} // namespace trim
@@ -0,0 +1,19 @@
+#pragma once
+#include <trim/render/glyph_table.hpp>
+#include <trim/render/palette.hpp>
+
+namespace trim
+{
+  /*!
+   * A painted cell: an interned glyph and an interned color, see Glyph_Table and Palette.
+   */
+  struct Cell
+  {
+    Glyph_Table::id_type glyph {};
+    Palette::index_type color {};
+
+    bool operator==(Cell const&) const = default;
+  };
+
+  static_assert(sizeof(Cell) == 4);
+} // namespace trim
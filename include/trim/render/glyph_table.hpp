@@ -0,0 +1,134 @@
+#pragma once
+#include <trim/util/assert.hpp>
+#include <trim/util/ints.hpp>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace trim
+{
+  namespace detail
+  {
+    // every single byte glyph, so that a glyph id below 256 can be viewed without storage
+    constexpr inline std::array<char, 256> single_byte_glyphs = []() {
+      std::array<char, 256> result {};
+      for(std::size_t i = 0; i < result.size(); ++i)
+        result[i] = static_cast<char>(i);
+      return result;
+    }();
+  } // namespace detail
+
+  /*!
+   * Interns the glyphs painted on a canvas into small integer ids.
+   * Id 0 is the empty glyph, ids 1 to 255 are single byte glyphs (label characters),
+   * and multi-byte glyphs (box drawing characters of a style) get ids from 256 in order of appearance.
+   * Labels may bring any number of multi-byte characters, so lookups go through an open addressing hash table.
+   */
+  struct Glyph_Table
+  {
+    using id_type = std::uint16_t;
+
+    static constexpr id_type empty_id = 0;
+    static constexpr id_type first_interned_id = 256;
+
+    private:
+
+    std::vector<std::string> m_glyphs {};
+
+    // ids of the interned glyphs, empty_id in free slots
+    std::vector<id_type> m_slots {};
+
+    // the last multi-byte glyph interned, consecutive cells of a line often paint the same glyph
+    id_type m_last_id = empty_id;
+
+    public:
+
+    constexpr Glyph_Table()
+      : m_glyphs()
+      , m_slots(64, empty_id)
+      , m_last_id(empty_id)
+    {}
+
+    [[nodiscard]] constexpr id_type intern(std::string_view glyph)
+    {
+      if(glyph.empty())
+        return empty_id;
+
+      if(glyph.size() == 1)
+        return static_cast<id_type>(static_cast<unsigned char>(glyph[0]));
+
+      // the bytes are compared, the view may point to memory reused for another glyph since
+      if(m_last_id != empty_id && bytes(m_last_id) == glyph)
+        return m_last_id;
+
+      size_type const slot = find_slot(glyph);
+      if(m_slots[slot] == empty_id) {
+        TRIM_ASSERT(first_interned_id + m_glyphs.size() <= UINT16_MAX);
+        m_slots[slot] = static_cast<id_type>(first_interned_id + m_glyphs.size());
+        m_glyphs.emplace_back(glyph);
+      }
+      m_last_id = m_slots[slot];
+
+      // keep the table at most half full
+      if(m_glyphs.size() * 2 > m_slots.size())
+        grow();
+
+      return m_last_id;
+    }
+
+    [[nodiscard]] constexpr std::string_view bytes(id_type id) const noexcept
+    {
+      if(id == empty_id)
+        return "";
+
+      if(id < first_interned_id)
+        return std::string_view(detail::single_byte_glyphs.data() + id, 1);
+
+      TRIM_ASSERT(size_type(id - first_interned_id) < m_glyphs.size());
+      return m_glyphs[id - first_interned_id];
+    }
+
+    // no multi-byte glyph was interned, the id of every glyph is its byte (or 0 for the empty glyph)
+    [[nodiscard]] constexpr bool is_single_byte() const noexcept
+    {
+      return m_glyphs.empty();
+    }
+
+    // blank cells look the same in any color
+    [[nodiscard]] static constexpr bool is_blank(id_type id) noexcept
+    {
+      return id == empty_id || id == id_type(' ');
+    }
+
+    private:
+
+    // FNV-1a over the bytes, glyphs are a few bytes long
+    [[nodiscard]] static constexpr std::uint64_t hash(std::string_view glyph) noexcept
+    {
+      std::uint64_t result = 0xCBF29CE484222325;
+      for(char c : glyph)
+        result = (result ^ static_cast<unsigned char>(c)) * 0x100000001B3;
+      return result;
+    }
+
+    // the slot holding the glyph, or the empty slot where it should be inserted
+    [[nodiscard]] constexpr size_type find_slot(std::string_view glyph) const noexcept
+    {
+      size_type const mask = m_slots.size() - 1;
+      size_type slot = static_cast<size_type>(hash(glyph)) & mask;
+      while(m_slots[slot] != empty_id && bytes(m_slots[slot]) != glyph)
+        slot = (slot + 1) & mask;
+      return slot;
+    }
+
+    constexpr void grow()
+    {
+      m_slots = std::vector<id_type>(m_slots.size() * 2, empty_id);
+      for(size_type i = 0; i < m_glyphs.size(); ++i)
+        m_slots[find_slot(m_glyphs[i])] = static_cast<id_type>(first_interned_id + i);
+    }
+  };
+} // namespace trim
@@ -0,0 +1,121 @@
+#pragma once
+#include <trim/color/rgb.hpp>
+#include <trim/render/row_encoder.hpp>
+#include <trim/style/style.hpp>
+#include <trim/util/ints.hpp>
+
+#include <array>
+#include <string>
+#include <string_view>
+
+namespace trim
+{
+  /*!
+   * Options of the HTML row markup.
+   */
+  struct Html_Options
+  {
+    // drop the blanks after the last visible glyph of a row
+    bool trim_trailing_blanks = false;
+  };
+
+  /*!
+   * Marks up colors with HTML spans, see Row_Encoder.
+   * The box, branch and text colors of the style are CSS classes defined once by html_stylesheet(),
+   * so a run of one of them costs a short <span class>. Other colors (rainbow) get an inline style.
+   * Glyphs with a meaning in HTML are written as entities.
+   */
+  struct Html_Markup
+  {
+    static constexpr bool escapes_glyphs = true;
+
+    private:
+
+    Color_RGB m_box_color {};
+    Color_RGB m_branch_color {};
+    Color_RGB m_text_color {};
+    Html_Options m_options {};
+
+    public:
+
+    Html_Markup() = default;
+
+    explicit constexpr Html_Markup(Style const& style, Html_Options const& options = {}) noexcept
+      : m_box_color(style.box_color)
+      , m_branch_color(style.branch_color)
+      , m_text_color(style.text_color)
+      , m_options(options)
+    {}
+
+    [[nodiscard]] constexpr bool trim_trailing_blanks() const noexcept
+    {
+      return m_options.trim_trailing_blanks;
+    }
+
+    [[nodiscard]] constexpr coord_type cursor_forward_min_blanks() const noexcept
+    {
+      return 0;
+    }
+
+    constexpr void format_color(std::string& begin, std::string& end, Color_RGB color) const
+    {
+      if(color == Color_RGB::NONE)
+        return;
+
+      end = "</span>";
+      if(color == m_box_color) {
+        begin = "<span class=\"trim-box\">";
+      } else if(color == m_branch_color) {
+        begin = "<span class=\"trim-branch\">";
+      } else if(color == m_text_color) {
+        begin = "<span class=\"trim-text\">";
+      } else {
+        std::array<char, color_hex_size> hex {};
+        char* const last = trim::format_color_hex(hex.data(), color);
+        begin = "<span style=\"color:";
+        begin.append(hex.data(), last);
+        begin.append("\">");
+      }
+    }
+
+    constexpr void format_glyph(std::string& out, std::string_view glyph) const
+    {
+      if(glyph == "&")
+        out = "&amp;";
+      else if(glyph == "<")
+        out = "&lt;";
+      else if(glyph == ">")
+        out = "&gt;";
+      else
+        out.assign(glyph);
+    }
+  };
+
+  static_assert(Is_Row_Markup<Html_Markup>);
+
+  // encodes rows of a canvas as the lines of an HTML <pre> block
+  using Html_Encoder = Row_Encoder<Html_Markup>;
+
+  /*!
+   * The CSS rules of the classes written by Html_Markup.
+   * Colors that are not set or are rainbow have no rule.
+   */
+  [[nodiscard]] constexpr std::string html_stylesheet(Style const& style)
+  {
+    std::string result = ".trim { line-height: 1.2; }\n";
+
+    auto const add_rule = [&](std::string_view name, Color_RGB color) -> void {
+      if(color == Color_RGB::NONE || color == Color_RGB::RAINBOW)
+        return;
+
+      std::array<char, color_hex_size> hex {};
+      char* const last = trim::format_color_hex(hex.data(), color);
+      result.append(".trim-").append(name).append(" { color: ").append(hex.data(), last).append("; }\n");
+    };
+
+    add_rule("box", style.box_color);
+    add_rule("branch", style.branch_color);
+    add_rule("text", style.text_color);
+    return result;
+  }
+} // namespace trim
@@ -0,0 +1,204 @@
+#pragma once
+#include <trim/render/ansi.hpp>
+#include <trim/render/byte_buffer.hpp>
+#include <trim/render/canvas.hpp>
+#include <trim/render/sink.hpp>
+#include <trim/util/format_int.hpp>
+#include <trim/util/geometry.hpp>
+
+#include <array>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace trim
+{
+  /*!
+   * Redraws a changing scene on a terminal by writing only the cells that changed since the last frame.
+   * Frames are rasterized into a single canvas, so glyph and color ids stay the same from frame to frame
+   * and cells are compared as integers. Each changed run is written after a cursor position sequence,
+   * unchanged gaps shorter than a cursor move are written over, and the whole update is wrapped in a
+   * synchronized update so the terminal shows it at once.
+   * The first frame, or a frame of another size, clears the screen and is written in full.
+   * Frames are drawn from the top left corner of the screen.
+   */
+  struct Live_Screen
+  {
+    private:
+
+    // unchanged cells between two changed runs are rewritten when that is shorter than moving the cursor
+    static constexpr size_type max_rewritten_gap = 6;
+
+    static constexpr std::string_view begin_update = "\033[?2026h";
+    static constexpr std::string_view end_update = "\033[?2026l";
+    static constexpr std::string_view clear_screen = "\033[H\033[2J";
+
+    Ansi_Markup m_markup {};
+    Canvas m_canvas {};
+    // cells of the frame shown on the screen, in the layout of m_canvas
+    std::vector<Cell> m_shown {};
+    Rect m_shown_rect {};
+    bool m_has_shown {};
+    std::vector<std::string> m_colors {};
+
+    public:
+
+    Live_Screen() = default;
+
+    // only the color depth of the options is used, frames are never trimmed or skipped over
+    explicit constexpr Live_Screen(Ansi_Options const& options)
+      : m_markup(Ansi_Markup(Ansi_Options {.color_depth = options.color_depth}))
+      , m_canvas()
+      , m_shown()
+      , m_shown_rect()
+      , m_has_shown(false)
+      , m_colors()
+    {}
+
+    // clears the canvas of the next frame and moves it to rect, the caller rasterizes the frame into it
+    [[nodiscard]] constexpr Canvas& next_frame(Rect rect)
+    {
+      m_canvas.reset(rect);
+      return m_canvas;
+    }
+
+    // the next frame is written in full, after the screen was changed by someone else
+    constexpr void invalidate() noexcept
+    {
+      m_has_shown = false;
+    }
+
+    /*!
+     * Appends the bytes turning the shown frame into the next one, nothing if no visible cell changed.
+     * The next frame is the shown one afterwards.
+     */
+    template<Is_Byte_Buffer Buffer>
+    constexpr void append_update(Buffer& out)
+    {
+      Rect const rect = m_canvas.rect();
+      update_colors(m_canvas.palette());
+
+      // frames are drawn at the same place wherever they are in the scene, only their size matters
+      bool const redraw = !m_has_shown || trim::width(m_shown_rect) != trim::width(rect) || trim::height(m_shown_rect) != trim::height(rect);
+      if(redraw) {
+        trim::append_bytes(out, begin_update);
+        trim::append_bytes(out, clear_screen);
+        m_shown.assign(static_cast<size_type>((trim::height(rect) + 1) * (trim::width(rect) + 1)), Cell {});
+      }
+
+      bool changed = redraw;
+      Palette::index_type active_color = Palette::none_index;
+      for(coord_type line = top_line(rect); line <= bot_line(rect); ++line) {
+        std::span<Cell const> const cells = m_canvas.row(line);
+        std::span<Cell> const shown = shown_row(line);
+
+        for(size_type column = 0; column < cells.size();) {
+          if(looks_same(cells[column], shown[column])) {
+            column += 1;
+            continue;
+          }
+
+          // the changed run, extended over short unchanged gaps
+          size_type end = column + 1;
+          for(size_type next = end; next < cells.size() && next - end <= max_rewritten_gap; ++next) {
+            if(!looks_same(cells[next], shown[next]))
+              end = next + 1;
+          }
+
+          if(!changed) {
+            trim::append_bytes(out, begin_update);
+            changed = true;
+          }
+
+          append_cursor_position(out, line - top_line(rect), coord_type(column));
+          for(size_type i = column; i < end; ++i) {
+            Cell const cell = cells[i];
+            if(Glyph_Table::is_blank(cell.glyph)) {
+              trim::append_byte(out, ' ');
+            } else {
+              select_color(out, active_color, cell.color);
+              trim::append_bytes(out, m_canvas.glyph_table().bytes(cell.glyph));
+            }
+          }
+
+          std::ranges::copy(cells.subspan(column, end - column), shown.begin() + ssize_type(column));
+          column = end;
+        }
+      }
+
+      m_shown_rect = rect;
+      m_has_shown = true;
+      if(!changed)
+        return;
+
+      // the cursor is left on the line below the frame
+      select_color(out, active_color, Palette::none_index);
+      append_cursor_position(out, trim::height(rect) + 1, 0);
+      trim::append_bytes(out, end_update);
+    }
+
+    // writes the update to a sink (see Is_Sink) or a stream in a single write
+    template<typename Output>
+    constexpr void present(Output& output)
+    {
+      std::string update {};
+      append_update(update);
+      if(update.empty())
+        return;
+
+      if constexpr(Is_Sink<Output>) {
+        output.write(update);
+      } else {
+        Stream_Sink<Output>(output).write(update);
+      }
+    }
+
+    private:
+
+    [[nodiscard]] static constexpr bool looks_same(Cell lhs, Cell rhs) noexcept
+    {
+      return lhs == rhs || (Glyph_Table::is_blank(lhs.glyph) && Glyph_Table::is_blank(rhs.glyph));
+    }
+
+    [[nodiscard]] constexpr std::span<Cell> shown_row(coord_type line) noexcept
+    {
+      size_type const width = static_cast<size_type>(trim::width(m_canvas.rect()) + 1);
+      size_type const begin = static_cast<size_type>(line - top_line(m_canvas.rect())) * width;
+      return std::span<Cell>(m_shown.data() + begin, width);
+    }
+
+    constexpr void update_colors(Palette const& palette)
+    {
+      for(size_type index = m_colors.size(); index < palette.size(); ++index) {
+        std::string begin {};
+        std::string end {};
+        m_markup.format_color(begin, end, palette[static_cast<Palette::index_type>(index)]);
+        m_colors.push_back(std::move(begin));
+      }
+    }
+
+    template<Is_Byte_Buffer Buffer>
+    constexpr void select_color(Buffer& out, Palette::index_type& active_color, Palette::index_type color) const
+    {
+      if(color == active_color)
+        return;
+
+      trim::append_bytes(out, m_colors[color]);
+      active_color = color;
+    }
+
+    // moves the cursor to a cell of the frame, lines and columns of the screen count from 1
+    template<Is_Byte_Buffer Buffer>
+    static constexpr void append_cursor_position(Buffer& out, coord_type line, coord_type column)
+    {
+      std::array<char, 32> buffer {};
+      char* end = std::ranges::copy(std::string_view("\033["), buffer.data()).out;
+      end = trim::format_integer(end, static_cast<unsigned long>(line + 1));
+      *end++ = ';';
+      end = trim::format_integer(end, static_cast<unsigned long>(column + 1));
+      *end++ = 'H';
+      trim::append_bytes(out, std::string_view(buffer.data(), end));
+    }
+  };
+} // namespace trim
@@ -0,0 +1,102 @@
+#pragma once
+#include <trim/color/rgb.hpp>
+#include <trim/util/assert.hpp>
+#include <trim/util/ints.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace trim
+{
+  /*!
+   * Interns the colors painted on a canvas into small integer indices.
+   * Index 0 is Color_RGB::NONE, other colors get indices in order of appearance.
+   * Rainbow styles use up to 1024 distinct colors, so lookups go through an open addressing hash table.
+   */
+  struct Palette
+  {
+    using index_type = std::uint16_t;
+
+    static constexpr index_type none_index = 0;
+
+    private:
+
+    static constexpr std::uint32_t empty_key = 0xFFFFFFFF;
+
+    struct Slot
+    {
+      std::uint32_t key = empty_key;
+      index_type index {};
+    };
+
+    std::vector<Color_RGB> m_colors {};
+    std::vector<Slot> m_slots {};
+
+    public:
+
+    constexpr Palette()
+      : m_colors(1, Color_RGB::NONE)
+      , m_slots(64)
+    {}
+
+    [[nodiscard]] constexpr index_type intern(Color_RGB color)
+    {
+      if(color == Color_RGB::NONE)
+        return none_index;
+
+      std::uint32_t const key = pack(color);
+      size_type slot = find_slot(key);
+      if(m_slots[slot].key == key)
+        return m_slots[slot].index;
+
+      TRIM_ASSERT(m_colors.size() <= UINT16_MAX);
+      index_type const index = static_cast<index_type>(m_colors.size());
+      m_colors.push_back(color);
+      m_slots[slot] = Slot {.key = key, .index = index};
+
+      // keep the table at most half full
+      if(m_colors.size() * 2 > m_slots.size())
+        grow();
+
+      return index;
+    }
+
+    [[nodiscard]] constexpr Color_RGB operator[](index_type index) const noexcept
+    {
+      TRIM_ASSERT(index < m_colors.size());
+      return m_colors[index];
+    }
+
+    [[nodiscard]] constexpr size_type size() const noexcept
+    {
+      return m_colors.size();
+    }
+
+    private:
+
+    [[nodiscard]] static constexpr std::uint32_t pack(Color_RGB color) noexcept
+    {
+      return (std::uint32_t(color.red & 0xFF) << 16) | (std::uint32_t(color.green & 0xFF) << 8) | std::uint32_t(color.blue & 0xFF);
+    }
+
+    // the slot holding the key, or the empty slot where it should be inserted
+    [[nodiscard]] constexpr size_type find_slot(std::uint32_t key) const noexcept
+    {
+      size_type const mask = m_slots.size() - 1;
+      size_type slot = static_cast<size_type>((key * std::uint32_t(0x9E3779B1)) >> 7) & mask;
+      while(m_slots[slot].key != key && m_slots[slot].key != empty_key)
+        slot = (slot + 1) & mask;
+      return slot;
+    }
+
+    constexpr void grow()
+    {
+      std::vector<Slot> old_slots = std::move(m_slots);
+      m_slots = std::vector<Slot>(old_slots.size() * 2);
+      for(Slot const& slot : old_slots) {
+        if(slot.key != empty_key)
+          m_slots[find_slot(slot.key)] = slot;
+      }
+    }
+  };
+} // namespace trim
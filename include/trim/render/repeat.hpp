@@ -0,0 +1,65 @@
+#pragma once
+#include <trim/render/byte_buffer.hpp>
+#include <trim/util/ints.hpp>
+
+#include <algorithm>
+#include <concepts>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace trim
+{
+  namespace detail
+  {
+    template<typename Buffer>
+    constexpr void append_doubling(Buffer& out, std::string_view glyph, size_type count)
+    {
+      if(glyph.size() == 1) {
+        trim::append_fill(out, count, glyph[0]);
+        return;
+      }
+
+      // short runs are cheaper to copy one glyph at a time
+      if(count < 8 || std::is_constant_evaluated()) {
+        for(size_type i = 0; i < count; ++i)
+          out.insert(out.end(), glyph.begin(), glyph.end());
+        return;
+      }
+
+      // the first glyph is appended as is, the doubling copies the bytes already in the buffer
+      size_type const begin = out.size();
+      size_type const total = glyph.size() * count;
+      out.insert(out.end(), glyph.begin(), glyph.end());
+      out.resize(begin + total);
+      char* data = out.data() + begin;
+
+      size_type filled = glyph.size();
+      while(filled < total) {
+        size_type const size = std::min(filled, total - filled);
+        std::memcpy(data + filled, data, size);
+        filled += size;
+      }
+    }
+  } // namespace detail
+
+  /*!
+   * Appends count copies of a glyph, see Is_Byte_Buffer.
+   * Single byte glyphs are filled with memset. Longer glyphs are written once and then doubled:
+   * the copies already written are copied again with memcpy, so a run of n glyphs takes
+   * log2(n) calls that the standard library runs with vector loads and stores.
+   */
+  template<Is_Byte_Buffer Buffer>
+  constexpr void append_repeated(Buffer& out, std::string_view glyph, size_type count)
+  {
+    if(glyph.empty() || count == 0)
+      return;
+
+    if constexpr(std::same_as<Buffer, Byte_Count>) {
+      out.size += glyph.size() * count;
+    } else {
+      trim::detail::append_doubling(out, glyph, count);
+    }
+  }
+} // namespace trim
@@ -0,0 +1,263 @@
+#pragma once
+#include <trim/color/rgb.hpp>
+#include <trim/render/byte_buffer.hpp>
+#include <trim/render/canvas.hpp>
+#include <trim/render/repeat.hpp>
+#include <trim/render/sparse_canvas.hpp>
+#include <trim/util/assert.hpp>
+#include <trim/util/format_int.hpp>
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace trim
+{
+  /*!
+   * How a row encoder marks up colors and glyphs (ANSI escapes, HTML spans).
+   * format_color() gives the bytes written when a run of a color begins and ends,
+   * format_glyph() the bytes of a glyph in the output.
+   */
+  template<typename T>
+  concept Is_Row_Markup = requires(T const& markup, std::string& begin, std::string& end, Color_RGB color, std::string_view glyph) {
+    // clang-format off
+    { T::escapes_glyphs } -> std::convertible_to<bool>;
+    { markup.trim_trailing_blanks() } -> std::same_as<bool>;
+    { markup.cursor_forward_min_blanks() } -> std::same_as<coord_type>;
+    { markup.format_color(begin, end, color) };
+    { markup.format_glyph(begin, glyph) };
+    // clang-format on
+  };
+
+  /*!
+   * Encodes rows of a canvas as text, with colors marked up by a Markup.
+   * The markup of every palette color is formatted once, the first time the color is met,
+   * so writing a row only copies bytes. Colors are only switched when a visible glyph
+   * needs a different color, and every row ends with the default color selected.
+   * Palette indices are local to a canvas, an encoder must only be used with a single canvas.
+   * Rows are appended to any Is_Byte_Buffer, a Byte_Count gives the exact size of a row without writing it.
+   */
+  template<Is_Row_Markup Markup>
+  struct Row_Encoder
+  {
+    private:
+
+    Markup m_markup {};
+    std::vector<std::string> m_color_begin {};
+    std::vector<std::string> m_color_end {};
+    // glyphs as written by the markup, only used when it escapes glyphs
+    std::vector<std::string> m_glyphs {};
+
+    public:
+
+    Row_Encoder() = default;
+
+    explicit constexpr Row_Encoder(Markup markup)
+      : m_markup(std::move(markup))
+      , m_color_begin()
+      , m_color_end()
+      , m_glyphs()
+    {}
+
+    // appends a row of the canvas followed by a newline
+    template<Is_Byte_Buffer Buffer>
+    constexpr void append_row(Buffer& out, Canvas const& canvas, coord_type line)
+    {
+      Glyph_Table const& glyphs = canvas.glyph_table();
+      update_colors(canvas.palette());
+      Palette::index_type active_color = Palette::none_index;
+
+      if(is_byte_copy(glyphs)) {
+        append_byte_row(out, canvas.row(line));
+        return;
+      }
+
+      // blanks are written when the next visible glyph is found
+      // a blank looks the same in any foreground color, so it never changes the active color
+      coord_type blanks = 0;
+
+      std::span<Cell const> const cells = canvas.row(line);
+      for(size_type i = 0; i < cells.size();) {
+        Cell const cell = cells[i];
+        if(Glyph_Table::is_blank(cell.glyph)) {
+          blanks += 1;
+          i += 1;
+          continue;
+        }
+
+        append_blanks(out, blanks);
+        blanks = 0;
+
+        // trunks and box borders are long runs of the same glyph, they are expanded at once
+        size_type run = 1;
+        while(i + run < cells.size() && cells[i + run] == cell)
+          run += 1;
+
+        select_color(out, active_color, cell.color);
+        trim::append_repeated(out, glyph_bytes(glyphs, cell.glyph), run);
+        i += run;
+      }
+
+      append_row_end(out, active_color, blanks);
+    }
+
+    // appends a row of a finalized sparse canvas followed by a newline, the gaps between spans are written as blanks
+    template<Is_Byte_Buffer Buffer>
+    constexpr void append_row(Buffer& out, Sparse_Canvas const& canvas, coord_type line)
+    {
+      Glyph_Table const& glyphs = canvas.glyph_table();
+      update_colors(canvas.palette());
+      Palette::index_type active_color = Palette::none_index;
+      coord_type column = left_column(canvas.rect());
+
+      for(Glyph_Span const& span : canvas.spans(line)) {
+        append_blanks(out, span.column - column);
+        select_color(out, active_color, span.color);
+        std::span<Glyph_Table::id_type const> const ids = canvas.glyphs(line, span);
+        if(is_byte_copy(glyphs)) {
+          trim::append_transformed(out, ids, &glyph_byte);
+          column = span.column + coord_type(span.size);
+          continue;
+        }
+
+        for(size_type i = 0; i < ids.size();) {
+          size_type run = 1;
+          while(i + run < ids.size() && ids[i + run] == ids[i])
+            run += 1;
+
+          trim::append_repeated(out, glyph_bytes(glyphs, ids[i]), run);
+          i += run;
+        }
+        column = span.column + coord_type(span.size);
+      }
+
+      append_row_end(out, active_color, right_column(canvas.rect()) + 1 - column);
+    }
+
+    private:
+
+    // rows of single byte glyphs are written as bytes, without looking up the glyphs
+    [[nodiscard]] constexpr bool is_byte_copy(Glyph_Table const& glyphs) const noexcept
+    {
+      return !Markup::escapes_glyphs && glyphs.is_single_byte();
+    }
+
+    [[nodiscard]] static constexpr char glyph_byte(Glyph_Table::id_type id) noexcept
+    {
+      TRIM_ASSERT(id < Glyph_Table::first_interned_id);
+      return id == Glyph_Table::empty_id ? ' ' : static_cast<char>(static_cast<unsigned char>(id));
+    }
+
+    // copies the cells of a row of single byte glyphs, the markup is only written where the color changes
+    template<Is_Byte_Buffer Buffer>
+    constexpr void append_byte_row(Buffer& out, std::span<Cell const> cells)
+    {
+      size_type end = cells.size();
+      if(m_markup.trim_trailing_blanks()) {
+        while(end > 0 && Glyph_Table::is_blank(cells[end - 1].glyph))
+          end -= 1;
+      }
+
+      Palette::index_type active_color = Palette::none_index;
+      coord_type const min_blanks = m_markup.cursor_forward_min_blanks();
+      for(size_type i = 0; i < end;) {
+        // the cells up to the next visible glyph of another color, or the next run of blanks to skip
+        size_type next = i;
+        size_type blanks = 0;
+        while(next < end) {
+          Cell const cell = cells[next];
+          if(Glyph_Table::is_blank(cell.glyph)) {
+            blanks += 1;
+          } else if(cell.color != active_color || (min_blanks > 0 && coord_type(blanks) >= min_blanks)) {
+            break;
+          } else {
+            blanks = 0;
+          }
+          next += 1;
+        }
+
+        // blanks before a color change or a skip are written by append_blanks
+        size_type const copied = (next < end ? next - blanks : next);
+        trim::append_transformed(out, cells.subspan(i, copied - i), [](Cell const& cell) noexcept { return glyph_byte(cell.glyph); });
+
+        if(next < end) {
+          append_blanks(out, coord_type(blanks));
+          select_color(out, active_color, cells[next].color);
+        }
+        i = next;
+      }
+
+      select_color(out, active_color, Palette::none_index);
+      trim::append_byte(out, '\n');
+    }
+
+    // formats the markup of the colors added to the palette since the last row
+    constexpr void update_colors(Palette const& palette)
+    {
+      for(size_type index = m_color_begin.size(); index < palette.size(); ++index) {
+        std::string begin {};
+        std::string end {};
+        m_markup.format_color(begin, end, palette[static_cast<Palette::index_type>(index)]);
+        m_color_begin.push_back(std::move(begin));
+        m_color_end.push_back(std::move(end));
+      }
+    }
+
+    [[nodiscard]] constexpr std::string_view glyph_bytes(Glyph_Table const& glyphs, Glyph_Table::id_type id)
+    {
+      if constexpr(!Markup::escapes_glyphs) {
+        return glyphs.bytes(id);
+      } else {
+        if(id >= m_glyphs.size())
+          m_glyphs.resize(size_type(id) + 1);
+
+        // glyphs are never empty, an empty entry has not been formatted yet
+        if(m_glyphs[id].empty())
+          m_markup.format_glyph(m_glyphs[id], glyphs.bytes(id));
+        return m_glyphs[id];
+      }
+    }
+
+    template<Is_Byte_Buffer Buffer>
+    constexpr void select_color(Buffer& out, Palette::index_type& active_color, Palette::index_type color) const
+    {
+      if(color == active_color)
+        return;
+
+      trim::append_bytes(out, m_color_end[active_color]);
+      trim::append_bytes(out, m_color_begin[color]);
+      active_color = color;
+    }
+
+    // writes a run of blanks followed by a visible glyph
+    template<Is_Byte_Buffer Buffer>
+    constexpr void append_blanks(Buffer& out, coord_type count) const
+    {
+      coord_type const min_blanks = m_markup.cursor_forward_min_blanks();
+      if(min_blanks > 0 && count >= min_blanks) {
+        std::array<char, 32> buffer {};
+        char* end = std::ranges::copy(std::string_view("\033["), buffer.data()).out;
+        end = trim::format_integer(end, static_cast<unsigned long>(count));
+        *end++ = 'C';
+        trim::append_bytes(out, std::string_view(buffer.data(), end));
+        return;
+      }
+
+      trim::append_fill(out, static_cast<size_type>(count), ' ');
+    }
+
+    // writes the blanks at the end of a row, the default color and the newline
+    template<Is_Byte_Buffer Buffer>
+    constexpr void append_row_end(Buffer& out, Palette::index_type& active_color, coord_type trailing_blanks) const
+    {
+      if(!m_markup.trim_trailing_blanks())
+        trim::append_fill(out, static_cast<size_type>(trailing_blanks), ' ');
+      select_color(out, active_color, Palette::none_index);
+      trim::append_byte(out, '\n');
+    }
+  };
+} // namespace trim
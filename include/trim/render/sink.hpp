@@ -0,0 +1,187 @@
+#pragma once
+#include <trim/port/write.hpp>
+#include <trim/util/ints.hpp>
+
+#include <concepts>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace trim
+{
+  /*!
+   * Receives rendered output in bulk, one contiguous block of bytes at a time.
+   */
+  template<typename T>
+  concept Is_Sink = requires(T& sink, std::string_view bytes) {
+    // clang-format off
+    { sink.write(bytes) };
+    // clang-format on
+  };
+
+  /*!
+   * Adapts a stream to a sink.
+   * Streams with a bulk write(data, size) member (std::ostream) get a single call per block,
+   * other streams (Memory_OStream) receive the block through operator<<.
+   */
+  template<typename Stream>
+  struct Stream_Sink
+  {
+    private:
+
+    Stream* m_stream {};
+
+    public:
+
+    explicit constexpr Stream_Sink(Stream& stream) noexcept
+      : m_stream(&stream)
+    {}
+
+    constexpr void write(std::string_view bytes)
+    {
+      if constexpr(requires { m_stream->write(bytes.data(), bytes.size()); }) {
+        m_stream->write(bytes.data(), bytes.size());
+      } else {
+        *m_stream << bytes;
+      }
+    }
+  };
+
+  /*!
+   * Collects all the output in a string.
+   */
+  struct String_Sink
+  {
+    private:
+
+    std::string m_string {};
+
+    public:
+
+    String_Sink() = default;
+
+    constexpr void write(std::string_view bytes)
+    {
+      m_string.append(bytes);
+    }
+
+    [[nodiscard]] constexpr std::string const& str() const& noexcept
+    {
+      return m_string;
+    }
+
+    [[nodiscard]] constexpr std::string str() && noexcept
+    {
+      return std::move(m_string);
+    }
+  };
+
+  /*!
+   * Counts the bytes written, for writers that have no output_size() of their own.
+   */
+  struct Count_Sink
+  {
+    private:
+
+    size_type m_size {};
+
+    public:
+
+    Count_Sink() = default;
+
+    constexpr void write(std::string_view bytes) noexcept
+    {
+      m_size += bytes.size();
+    }
+
+    [[nodiscard]] constexpr size_type size() const noexcept
+    {
+      return m_size;
+    }
+  };
+
+  /*!
+   * Writes straight to a file descriptor with write(2).
+   * Should be wrapped in a Buffered_Sink, so that every system call carries a large block.
+   */
+  struct Fd_Sink
+  {
+    private:
+
+    int m_fd {};
+    bool m_ok {};
+
+    public:
+
+    explicit Fd_Sink(int fd) noexcept
+      : m_fd(fd)
+      , m_ok(true)
+    {}
+
+    void write(std::string_view bytes) noexcept
+    {
+      if(m_ok)
+        m_ok = trim::port::write_all(m_fd, bytes.data(), bytes.size());
+    }
+
+    // false if any write failed, output after the failure is dropped
+    [[nodiscard]] bool ok() const noexcept
+    {
+      return m_ok;
+    }
+  };
+
+  /*!
+   * Collects output in a growable contiguous buffer and forwards it to another sink
+   * in blocks of at least flush_threshold bytes.
+   * Remaining output is forwarded by flush() or on destruction.
+   */
+  template<Is_Sink Sink>
+  struct Buffered_Sink
+  {
+    static constexpr size_type flush_threshold = size_type(1) << 16;
+
+    private:
+
+    Sink m_sink;
+    std::vector<char> m_buffer {};
+
+    public:
+
+    explicit constexpr Buffered_Sink(Sink sink)
+      : m_sink(std::move(sink))
+      , m_buffer()
+    {
+      m_buffer.reserve(flush_threshold);
+    }
+
+    Buffered_Sink(Buffered_Sink const&) = delete;
+    Buffered_Sink& operator=(Buffered_Sink const&) = delete;
+
+    constexpr ~Buffered_Sink()
+    {
+      flush();
+    }
+
+    constexpr void write(std::string_view bytes)
+    {
+      m_buffer.insert(m_buffer.end(), bytes.begin(), bytes.end());
+      if(m_buffer.size() >= flush_threshold)
+        flush();
+    }
+
+    constexpr void flush()
+    {
+      if(m_buffer.empty())
+        return;
+
+      m_sink.write(std::string_view(m_buffer.data(), m_buffer.size()));
+      m_buffer.clear();
+    }
+
+    [[nodiscard]] constexpr Sink& sink() noexcept
+    {
+      return m_sink;
+    }
+  };
+} // namespace trim
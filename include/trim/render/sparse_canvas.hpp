@@ -0,0 +1,212 @@
+#pragma once
+#include <trim/render/canvas.hpp>
+#include <trim/render/glyph_table.hpp>
+#include <trim/render/palette.hpp>
+#include <trim/render/stamp.hpp>
+#include <trim/sprite/draw_result.hpp>
+#include <trim/style/style.hpp>
+#include <trim/util/assert.hpp>
+#include <trim/util/geometry.hpp>
+#include <trim/util/ints.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace trim
+{
+  /*!
+   * A run of visible glyphs of the same color on a row, starting at a column.
+   * The glyph ids of the run are glyphs[first, first + size) of the row.
+   */
+  struct Glyph_Span
+  {
+    coord_type column {};
+    std::uint32_t first {};
+    std::uint32_t size {};
+    Palette::index_type color {};
+  };
+
+  /*!
+   * A canvas that only stores painted cells, for scenes that are mostly blank.
+   * Painted cells are appended to their row, finalize() then sorts every row,
+   * keeps the last cell painted at each column (same as Canvas) and packs the visible
+   * cells into spans. Memory and encoding time are proportional to the painted cells,
+   * not to the area of the canvas.
+   */
+  struct Sparse_Canvas
+  {
+    private:
+
+    // a painted cell, seq is the paint order within the row
+    struct Entry
+    {
+      coord_type column {};
+      std::uint32_t seq {};
+      Cell cell {};
+    };
+
+    struct Row
+    {
+      std::vector<Entry> entries {};
+      std::vector<Glyph_Span> spans {};
+      std::vector<Glyph_Table::id_type> glyphs {};
+    };
+
+    Rect m_rect {};
+    std::vector<Row> m_rows {};
+    Glyph_Table m_glyphs {};
+    Palette m_palette {};
+    Stamp_Cache m_stamps {};
+    bool m_finalized {};
+
+    public:
+
+    Sparse_Canvas() = default;
+
+    explicit constexpr Sparse_Canvas(Rect rect)
+      : m_rect()
+      , m_rows()
+      , m_glyphs()
+      , m_palette()
+      , m_stamps()
+      , m_finalized()
+    {
+      reset(rect);
+    }
+
+    /*!
+     * Moves the canvas to another rect and clears all the cells.
+     * Interned glyphs, colors and stamps are kept, as well as the memory of the rows.
+     */
+    constexpr void reset(Rect rect)
+    {
+      m_rect = Rect(trim::top_left_corner(rect), trim::bot_right_corner(rect));
+      m_rows.resize(static_cast<size_type>(trim::height(m_rect) + 1));
+      for(Row& row : m_rows) {
+        row.entries.clear();
+        row.spans.clear();
+        row.glyphs.clear();
+      }
+      m_finalized = false;
+    }
+
+    [[nodiscard]] constexpr Rect rect() const noexcept
+    {
+      return m_rect;
+    }
+
+    [[nodiscard]] constexpr bool contains(Point point) const noexcept
+    {
+      return trim::envelopes(m_rect, point);
+    }
+
+    constexpr void paint(Point point, Draw_Result drawable)
+    {
+      TRIM_ASSERT(!m_finalized);
+      if(drawable.empty() || !contains(point))
+        return;
+
+      Row& row = m_rows[static_cast<size_type>(point.line - top_line(m_rect))];
+      Cell const cell = Cell {.glyph = m_glyphs.intern(drawable.character), .color = m_palette.intern(drawable.color)};
+      row.entries.push_back(Entry {.column = point.column, .seq = static_cast<std::uint32_t>(row.entries.size()), .cell = cell});
+    }
+
+    // the style stamps are rendered with, set before each raster pass
+    constexpr void set_style(Style const& style)
+    {
+      m_stamps.set_style(style);
+    }
+
+    // the stamp of a key, rendered by render(Stamp_Recorder&) the first time the key is seen
+    template<typename Render>
+    [[nodiscard]] constexpr Stamp const& stamp(std::uint64_t key, Rect rect, Render&& render)
+    {
+      return m_stamps.find(key, rect, m_glyphs, m_palette, std::forward<Render>(render));
+    }
+
+    // appends the cells of a stamp translated by origin, without interning them again
+    constexpr void paint(Point origin, Stamp const& stamp)
+    {
+      TRIM_ASSERT(!m_finalized);
+      Rect const rect = trim::translate(stamp.rect(), origin.line, origin.column);
+      if(!trim::intersects(rect, m_rect))
+        return;
+
+      Rect const clip = trim::intersection(rect, m_rect);
+      for(coord_type line = top_line(clip); line <= bot_line(clip); ++line) {
+        Row& row = m_rows[static_cast<size_type>(line - top_line(m_rect))];
+        for(Stamp::Entry const& entry : stamp.line(line - origin.line)) {
+          coord_type const column = origin.column + entry.column;
+          if(column >= left_column(clip) && column <= right_column(clip))
+            row.entries.push_back(Entry {.column = column, .seq = static_cast<std::uint32_t>(row.entries.size()), .cell = entry.cell});
+        }
+      }
+    }
+
+    // sorts the painted cells and builds the spans of every row
+    constexpr void finalize()
+    {
+      if(m_finalized)
+        return;
+
+      for(Row& row : m_rows) {
+        std::ranges::sort(row.entries, [](Entry const& lhs, Entry const& rhs) noexcept {
+          return lhs.column < rhs.column || (lhs.column == rhs.column && lhs.seq < rhs.seq);
+        });
+
+        for(size_type i = 0; i < row.entries.size(); ++i) {
+          // the last cell painted at a column wins
+          if(i + 1 < row.entries.size() && row.entries[i + 1].column == row.entries[i].column)
+            continue;
+
+          Entry const& entry = row.entries[i];
+          if(Glyph_Table::is_blank(entry.cell.glyph))
+            continue;
+
+          bool const extends_span = !row.spans.empty() && row.spans.back().color == entry.cell.color
+                                 && row.spans.back().column + coord_type(row.spans.back().size) == entry.column;
+
+          if(!extends_span) {
+            row.spans.push_back(Glyph_Span {.column = entry.column, .first = static_cast<std::uint32_t>(row.glyphs.size()), .size = 0, .color = entry.cell.color});
+          }
+
+          row.glyphs.push_back(entry.cell.glyph);
+          row.spans.back().size += 1;
+        }
+
+        row.entries.clear();
+      }
+
+      m_finalized = true;
+    }
+
+    [[nodiscard]] constexpr std::span<Glyph_Span const> spans(coord_type line) const noexcept
+    {
+      TRIM_ASSERT(m_finalized);
+      TRIM_ASSERT(line >= top_line(m_rect) && line <= bot_line(m_rect));
+      return m_rows[static_cast<size_type>(line - top_line(m_rect))].spans;
+    }
+
+    [[nodiscard]] constexpr std::span<Glyph_Table::id_type const> glyphs(coord_type line, Glyph_Span const& span) const noexcept
+    {
+      TRIM_ASSERT(m_finalized);
+      Row const& row = m_rows[static_cast<size_type>(line - top_line(m_rect))];
+      return std::span<Glyph_Table::id_type const>(row.glyphs.data() + span.first, span.size);
+    }
+
+    [[nodiscard]] constexpr Glyph_Table const& glyph_table() const noexcept
+    {
+      return m_glyphs;
+    }
+
+    [[nodiscard]] constexpr Palette const& palette() const noexcept
+    {
+      return m_palette;
+    }
+  };
+
+  static_assert(Is_Stamp_Canvas<Sparse_Canvas>);
+} // namespace trim
@@ -0,0 +1,171 @@
+#pragma once
+#include <trim/render/cell.hpp>
+#include <trim/render/glyph_table.hpp>
+#include <trim/render/palette.hpp>
+#include <trim/sprite/draw_result.hpp>
+#include <trim/style/style.hpp>
+#include <trim/util/assert.hpp>
+#include <trim/util/geometry.hpp>
+#include <trim/util/ints.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace trim
+{
+  /*!
+   * The painted cells of a sprite, rendered once and painted at many origins.
+   * Cells are grouped by line, so a canvas covering a few lines only visits the cells on those lines.
+   * Glyphs and colors are interned in the tables of the canvas that owns the stamp.
+   */
+  struct Stamp
+  {
+    struct Entry
+    {
+      coord_type column {};
+      Cell cell {};
+    };
+
+    private:
+
+    Rect m_rect {};
+    std::vector<Entry> m_entries {};
+    // entries of line i are m_entries[m_line_begin[i], m_line_begin[i + 1])
+    std::vector<std::uint32_t> m_line_begin {};
+
+    friend struct Stamp_Recorder;
+
+    public:
+
+    Stamp() = default;
+
+    explicit constexpr Stamp(Rect rect)
+      : m_rect(rect)
+      , m_entries()
+      , m_line_begin(1, 0)
+    {}
+
+    [[nodiscard]] constexpr Rect rect() const noexcept
+    {
+      return m_rect;
+    }
+
+    [[nodiscard]] constexpr std::span<Entry const> line(coord_type line) const noexcept
+    {
+      size_type const index = static_cast<size_type>(line - top_line(m_rect));
+      TRIM_ASSERT(index + 1 < m_line_begin.size());
+      return std::span<Entry const>(m_entries.data() + m_line_begin[index], m_line_begin[index + 1] - m_line_begin[index]);
+    }
+  };
+
+  /*!
+   * A canvas that records the cells of a stamp.
+   * Cells must be painted line by line, which is the order of raster_cells.
+   */
+  struct Stamp_Recorder
+  {
+    private:
+
+    Stamp* m_stamp {};
+    Glyph_Table* m_glyphs {};
+    Palette* m_palette {};
+
+    public:
+
+    constexpr Stamp_Recorder(Stamp& stamp, Glyph_Table& glyphs, Palette& palette) noexcept
+      : m_stamp(&stamp)
+      , m_glyphs(&glyphs)
+      , m_palette(&palette)
+    {}
+
+    [[nodiscard]] constexpr Rect rect() const noexcept
+    {
+      return m_stamp->m_rect;
+    }
+
+    constexpr void paint(Point point, Draw_Result drawable)
+    {
+      if(drawable.empty() || !trim::envelopes(rect(), point))
+        return;
+
+      size_type const index = static_cast<size_type>(point.line - top_line(rect()));
+      TRIM_ASSERT(index + 2 >= m_stamp->m_line_begin.size());
+      open_line(index);
+
+      Cell const cell = Cell {.glyph = m_glyphs->intern(drawable.character), .color = m_palette->intern(drawable.color)};
+      m_stamp->m_entries.push_back(Stamp::Entry {.column = point.column, .cell = cell});
+      m_stamp->m_line_begin.back() += 1;
+    }
+
+    // closes the remaining lines, the stamp is complete afterwards
+    constexpr void finish()
+    {
+      open_line(static_cast<size_type>(trim::height(rect())));
+    }
+
+    private:
+
+    // moves to the line at index, the last element of m_line_begin is the end of the line being painted
+    constexpr void open_line(size_type index)
+    {
+      while(m_stamp->m_line_begin.size() < index + 2)
+        m_stamp->m_line_begin.push_back(m_stamp->m_line_begin.back());
+    }
+  };
+
+  /*!
+   * The stamps rendered on a canvas, keyed by the shape of the sprite that rendered them.
+   * Stamps depend on the style, the cache keeps a copy of its style and is cleared when a style
+   * that compares different is set, even if it is the same object changed in place.
+   * The style is set once per raster pass, see Canvas::set_style, so finding a stamp only searches its key.
+   * A scene only has a few distinct shapes, they are kept sorted by key.
+   */
+  struct Stamp_Cache
+  {
+    private:
+
+    struct Slot
+    {
+      std::uint64_t key {};
+      Stamp stamp {};
+    };
+
+    std::vector<Slot> m_slots {};
+    std::optional<Style> m_style {};
+
+    public:
+
+    Stamp_Cache() = default;
+
+    // the style of the next stamps, the stamps of another style are dropped
+    constexpr void set_style(Style const& style)
+    {
+      if(m_style != style) {
+        m_slots.clear();
+        m_style = style;
+      }
+    }
+
+    /*!
+     * Returns the stamp of the key, render(recorder) is only called the first time a key is seen.
+     * The reference is valid until the next call.
+     */
+    template<typename Render>
+    [[nodiscard]] constexpr Stamp const& find(std::uint64_t key, Rect rect, Glyph_Table& glyphs, Palette& palette, Render&& render)
+    {
+      TRIM_ASSERT(m_style.has_value());
+      auto slot = std::ranges::lower_bound(m_slots, key, {}, &Slot::key);
+      if(slot != m_slots.end() && slot->key == key)
+        return slot->stamp;
+
+      Stamp stamp = Stamp(rect);
+      Stamp_Recorder recorder = Stamp_Recorder(stamp, glyphs, palette);
+      render(recorder);
+      recorder.finish();
+      return m_slots.insert(slot, Slot {.key = key, .stamp = std::move(stamp)})->stamp;
+    }
+  };
+} // namespace trim
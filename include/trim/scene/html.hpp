@@ -0,0 +1,33 @@
+#pragma once
+#include <trim/render/html.hpp>
+#include <trim/render/sink.hpp>
+#include <trim/scene/tree_stream.hpp>
+#include <trim/style/style.hpp>
+#include <trim/util/geometry.hpp>
+
+#include <string>
+
+namespace trim
+{
+  /*!
+   * Writes the window of a tree stream as an HTML page: a stylesheet with the colors of the style
+   * and a <pre> block with the rows, assembled by the same encoder as the text output.
+   */
+  template<typename Output>
+  constexpr void write_html(Output& output, Tree_Stream const& stream, Style const& style, Rect window, Html_Options const& options = {})
+  {
+    if constexpr(!Is_Sink<Output>) {
+      Stream_Sink<Output> sink = Stream_Sink<Output>(output);
+      write_html(sink, stream, style, window, options);
+    } else {
+      std::string head = "<!DOCTYPE html>\n<html>\n<head>\n<meta charset=\"utf-8\">\n<style>\n";
+      head.append(html_stylesheet(style));
+      head.append("</style>\n</head>\n<body>\n<pre class=\"trim\">\n");
+      output.write(head);
+
+      stream.draw(output, style, window, Html_Markup(style, options));
+
+      output.write("</pre>\n</body>\n</html>\n");
+    }
+  }
+} // namespace trim
@@ -0,0 +1,55 @@
+#pragma once
+#include <trim/render/sink.hpp>
+#include <trim/scene/tree_stream.hpp>
+#include <trim/util/geometry.hpp>
+#include <trim/util/task_pool.hpp>
+
+#include <algorithm>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace trim
+{
+  /*!
+   * Draws the window of a tree stream on several threads.
+   * The lines of the window are split in bands, each band is drawn by a worker into its own buffer,
+   * and the buffers are written to the sink in order, so the output does not depend on the scheduling.
+   * Bands are drawn in rounds of num_threads, which bounds the memory held by the buffers.
+   * The rounds run on the same threads, see Task_Pool.
+   */
+  template<Is_Sink Sink>
+  void draw_parallel(Tree_Stream const& stream, Sink& sink, Style const& style, Rect window, unsigned num_threads, Ansi_Options const& options = {})
+  {
+    // lines per band, small enough to keep all the workers busy on short scenes
+    static constexpr coord_type max_band_lines = 64;
+
+    num_threads = std::max(num_threads, 1u);
+    coord_type const num_lines = height(window) + 1;
+    coord_type const band_lines = std::clamp<coord_type>(num_lines / num_threads, 1, max_band_lines);
+
+    std::vector<String_Sink> buffers(num_threads);
+    // bands of a round have the same number of lines but the last one, they weigh the same
+    std::vector<size_type> const weights = std::vector<size_type>(num_threads, 1);
+    Task_Pool pool = Task_Pool(num_threads);
+
+    for(coord_type round_line = top_line(window); round_line <= bot_line(window);) {
+      // the window of each band, the last round may have fewer bands
+      std::vector<Rect> bands {};
+      for(unsigned i = 0; i < num_threads && round_line <= bot_line(window); ++i) {
+        coord_type const last_line = std::min(round_line + band_lines - 1, bot_line(window));
+        bands.push_back(Rect(Point(round_line, left_column(window)), Point(last_line, right_column(window))));
+        round_line = last_line + 1;
+      }
+
+      pool.run(std::span(weights).first(bands.size()), [&](size_type i) -> void {
+        stream.draw(buffers[i], style, bands[i], options);
+      });
+
+      for(size_type i = 0; i < bands.size(); ++i) {
+        sink.write(buffers[i].str());
+        buffers[i] = String_Sink();
+      }
+    }
+  }
+} // namespace trim
@@ -1,9 +1,17 @@
 #pragma once
+#include <trim/render/ansi.hpp>
+#include <trim/render/byte_buffer.hpp>
+#include <trim/render/canvas.hpp>
+#include <trim/render/sink.hpp>
+#include <trim/render/sparse_canvas.hpp>
 #include <trim/sprite/composite.hpp>
 #include <trim/sprite/tree.hpp>
-#include <trim/util/format_int.hpp>
 #include <trim/util/geometry.hpp>
 
+#include <string>
+#include <string_view>
+#include <vector>
+
 namespace trim
 {
   struct Scene
@@ -24,6 +32,16 @@ namespace trim
       : m_composite(std::move(sprite))
     {}
 
+    explicit constexpr Scene(Tree_Sprite tree) //
+      : m_composite(std::move(tree).composite())
+    {}
+
+    template<typename T>
+      requires(!std::is_same_v<T, Tree_Sprite> && Is_Sprite_Group<T>)
+    explicit constexpr Scene(T const& group) //
+      : m_composite(group)
+    {}
+
     [[nodiscard]] constexpr Rect rect() const noexcept
     {
       return m_composite.rect();
@@ -35,45 +53,144 @@ namespace trim
       return m_composite.draw(style, cursor);
     }
 
-    template<typename Stream>
-    constexpr void draw(Stream& stream, Style const& style)
+    /*!
+     * Rasterizes the whole scene into a canvas.
+     * Every sprite paints its own cells once, so the cost is proportional
+     * to the scene area plus the number of painted cells.
+     */
+    [[nodiscard]] constexpr Canvas raster(Style const& style) const
+    {
+      return raster(style, rect());
+    }
+
+    /*!
+     * Rasterizes the part of the scene inside the window.
+     * Sprites outside the window are skipped, cells not covered by any sprite are blank.
+     */
+    [[nodiscard]] constexpr Canvas raster(Style const& style, Rect window) const
+    {
+      Canvas canvas = Canvas(window);
+      canvas.set_style(style);
+      m_composite.raster(style, canvas, Point::origin);
+      return canvas;
+    }
+
+    /*!
+     * Rasterizes the part of the scene inside the rect of an existing canvas, see Live_Screen::next_frame.
+     * The canvas keeps its interned glyphs and colors, and its stamps unless the style changed.
+     */
+    constexpr void raster(Style const& style, Canvas& canvas) const
+    {
+      canvas.set_style(style);
+      m_composite.raster(style, canvas, Point::origin);
+    }
+
+    /*!
+     * Writes the scene to a sink (see Is_Sink), or to a stream adapted by Stream_Sink.
+     * Each row is assembled in memory and handed to the sink in a single write.
+     */
+    template<typename Output>
+    constexpr void draw(Output& output, Style const& style)
+    {
+      draw(output, style, rect());
+    }
+
+    /*!
+     * Writes only the cells inside the viewport, one row per viewport line.
+     * The viewport is in scene coordinates and may extend past rect().
+     * The options select how rows are encoded, see Ansi_Options.
+     */
+    template<typename Output>
+    constexpr void draw(Output& output, Style const& style, Rect viewport, Ansi_Options const& options = {})
+    {
+      draw(output, style, viewport, Ansi_Markup(options));
+    }
+
+    // same as above, with the colors marked up by another markup than ANSI escapes
+    template<typename Output, Is_Row_Markup Markup>
+    constexpr void draw(Output& output, Style const& style, Rect viewport, Markup const& markup)
+    {
+      Sparse_Canvas const canvas = raster_sparse(style, viewport);
+      if constexpr(Is_Sink<Output>) {
+        draw_rows(output, canvas, markup);
+      } else {
+        Stream_Sink<Output> sink = Stream_Sink<Output>(output);
+        draw_rows(sink, canvas, markup);
+      }
+    }
+
+    /*!
+     * The exact number of bytes written by draw() with the same arguments,
+     * summed from the glyph bytes and the color changes of each row without writing them.
+     */
+    [[nodiscard]] constexpr size_type output_size(Style const& style, Rect viewport, Ansi_Options const& options = {}) const
+    {
+      return output_size(style, viewport, Ansi_Markup(options));
+    }
+
+    template<Is_Row_Markup Markup>
+    [[nodiscard]] constexpr size_type output_size(Style const& style, Rect viewport, Markup const& markup) const
+    {
+      Byte_Count count {};
+      encode_rows(count, raster_sparse(style, viewport), markup);
+      return count.size;
+    }
+
+    /*!
+     * Returns the output of draw() in a string allocated once.
+     * The scene is rasterized once, its rows are measured and then encoded in place.
+     */
+    [[nodiscard]] constexpr std::string render(Style const& style, Rect viewport, Ansi_Options const& options = {}) const
+    {
+      return render(style, viewport, Ansi_Markup(options));
+    }
+
+    template<Is_Row_Markup Markup>
+    [[nodiscard]] constexpr std::string render(Style const& style, Rect viewport, Markup const& markup) const
     {
-      Rect const rect = this->rect();
-      coord_type const line1 = top_line(rect);
-      coord_type const line2 = bot_line(rect);
-      coord_type const column1 = left_column(rect);
-      coord_type const column2 = right_column(rect);
-      std::array<char, 128> buffer {};
-
-      auto const print_colored = [&buffer](std::string_view character, Color_RGB color) -> std::string_view {
-        char* out = std::ranges::copy(std::string_view("\033[38;2;"), buffer.data()).out;
-        out = format_integer(out, static_cast<unsigned>(color.red));
-        *out++ = ';';
-        out = format_integer(out, static_cast<unsigned>(color.green));
-        *out++ = ';';
-        out = format_integer(out, static_cast<unsigned>(color.blue));
-        *out++ = 'm';
-        out = std::ranges::copy(character, out).out;
-        out = std::ranges::copy(std::string_view("\033[0;00m"), out).out;
-        *out++ = '\0';
-        return std::string_view(buffer.data(), out - buffer.data());
-      };
-
-      for(coord_type line = line1; line <= line2; ++line) {
-        for(coord_type column = column1; column <= column2; ++column) {
-          Draw_Result drawable = m_composite.draw(style, Point(line, column));
-
-          if(drawable.character == "")
-            drawable.character = " ";
-
-          if(drawable.color != Color_RGB::NONE && drawable.character != " ") {
-            stream << print_colored(drawable.character, drawable.color);
-          } else {
-            stream << drawable.character;
-          }
-        }
-
-        stream << '\n';
+      Sparse_Canvas const canvas = raster_sparse(style, viewport);
+      Byte_Count count {};
+      encode_rows(count, canvas, markup);
+
+      std::string result {};
+      result.reserve(count.size);
+      encode_rows(result, canvas, markup);
+      TRIM_ASSERT(result.size() == count.size);
+      return result;
+    }
+
+    private:
+
+    // most of a tree scene is blank, a sparse canvas only stores the painted cells
+    [[nodiscard]] constexpr Sparse_Canvas raster_sparse(Style const& style, Rect viewport) const
+    {
+      Sparse_Canvas canvas = Sparse_Canvas(viewport);
+      canvas.set_style(style);
+      m_composite.raster(style, canvas, Point::origin);
+      canvas.finalize();
+      return canvas;
+    }
+
+    template<Is_Byte_Buffer Buffer, Is_Row_Markup Markup>
+    static constexpr void encode_rows(Buffer& out, Sparse_Canvas const& canvas, Markup const& markup)
+    {
+      Rect const rect = canvas.rect();
+      Row_Encoder<Markup> encoder = Row_Encoder<Markup>(markup);
+      for(coord_type line = top_line(rect); line <= bot_line(rect); ++line)
+        encoder.append_row(out, canvas, line);
+    }
+
+    template<Is_Sink Sink, Is_Row_Markup Markup>
+    static constexpr void draw_rows(Sink& sink, Sparse_Canvas const& canvas, Markup const& markup)
+    {
+      Rect const rect = canvas.rect();
+      Row_Encoder<Markup> encoder = Row_Encoder<Markup>(markup);
+      std::vector<char> row {};
+
+      for(coord_type line = top_line(rect); line <= bot_line(rect); ++line) {
+        row.clear();
+        encoder.append_row(row, canvas, line);
+        sink.write(std::string_view(row.data(), row.size()));
       }
     }
   };
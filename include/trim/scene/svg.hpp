@@ -0,0 +1,224 @@
+#pragma once
+#include <trim/color/rgb.hpp>
+#include <trim/container/labels.hpp>
+#include <trim/container/tree.hpp>
+#include <trim/layout/tree_layout.hpp>
+#include <trim/render/sink.hpp>
+#include <trim/sprite/sprite.hpp>
+#include <trim/sprite/text.hpp>
+#include <trim/style/style.hpp>
+#include <trim/util/format_int.hpp>
+#include <trim/util/geometry.hpp>
+#include <trim/util/split.hpp>
+
+#include <array>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <string_view>
+
+namespace trim
+{
+  /*!
+   * The size of a cell of the scene in the SVG output, in pixels.
+   * Sizes are even so that the centers of the cells fall on whole pixels.
+   */
+  struct Svg_Options
+  {
+    coord_type cell_width = 10;
+    coord_type cell_height = 20;
+    coord_type font_size = 16;
+  };
+
+  namespace detail
+  {
+    // builds an SVG document in a string, handed to the sink in large blocks
+    template<Is_Sink Sink>
+    struct Svg_Writer
+    {
+      private:
+
+      static constexpr size_type flush_threshold = 64 * 1024;
+
+      Sink* m_sink {};
+      std::string m_buffer {};
+
+      public:
+
+      explicit constexpr Svg_Writer(Sink& sink)
+        : m_sink(&sink)
+        , m_buffer()
+      {}
+
+      constexpr Svg_Writer& operator<<(std::string_view string)
+      {
+        m_buffer.append(string);
+        return *this;
+      }
+
+      constexpr Svg_Writer& operator<<(coord_type value)
+      {
+        if(value < 0) {
+          m_buffer.push_back('-');
+          value = -value;
+        }
+
+        std::array<char, 24> digits {};
+        char* const end = trim::format_integer(digits.data(), static_cast<std::uint64_t>(value));
+        m_buffer.append(digits.data(), end);
+        return *this;
+      }
+
+      constexpr Svg_Writer& operator<<(Color_RGB color)
+      {
+        if(color == Color_RGB::NONE)
+          return *this << "black";
+
+        std::array<char, color_hex_size> hex {};
+        char* const end = trim::format_color_hex(hex.data(), color);
+        m_buffer.append(hex.data(), end);
+        return *this;
+      }
+
+      // writes a label, escaping the characters that have a meaning in XML
+      constexpr void text(std::string_view string)
+      {
+        for(char c : string) {
+          switch(c) {
+            case '&': m_buffer.append("&amp;"); break;
+            case '<': m_buffer.append("&lt;"); break;
+            case '>': m_buffer.append("&gt;"); break;
+            case '"': m_buffer.append("&quot;"); break;
+            default: m_buffer.push_back(c); break;
+          }
+        }
+      }
+
+      constexpr void flush_if_full()
+      {
+        if(m_buffer.size() >= flush_threshold)
+          flush();
+      }
+
+      constexpr void flush()
+      {
+        if(!m_buffer.empty())
+          m_sink->write(m_buffer);
+        m_buffer.clear();
+      }
+    };
+  } // namespace detail
+
+  /*!
+   * Writes a laid out tree as an SVG document, straight from the node rects and the tree topology.
+   * Each node is a <rect> and a <text>, each edge a <path> following the same route as the drawn branches.
+   * No sprite is built and no cell is visited, the output size and time are proportional to the number of nodes.
+   */
+  template<typename Output>
+  constexpr void write_svg(Output& output, Tree const& tree, [[maybe_unused]] size_type root, Labels const& node_labels, Tree_Layout const& layout, Style const& style, Svg_Options const& options = {})
+  {
+    if constexpr(!Is_Sink<Output>) {
+      Stream_Sink<Output> sink = Stream_Sink<Output>(output);
+      write_svg(sink, tree, root, node_labels, layout, style, options);
+    } else {
+      detail::Svg_Writer<Output> out = detail::Svg_Writer<Output>(output);
+      size_type const num_nodes = tree.size();
+
+      // the top left cell of the scene is at the origin of the document
+      Rect const scene = layout.rect();
+      coord_type const cell_width = options.cell_width;
+      coord_type const cell_height = options.cell_height;
+      auto const x = [&](coord_type column) noexcept { return (column - left_column(scene)) * cell_width + cell_width / 2; };
+      auto const y = [&](coord_type line) noexcept { return (line - top_line(scene)) * cell_height + cell_height / 2; };
+
+      // colors are set once on each group, rainbow styles override them on every element
+      auto const is_rainbow = [](Color_RGB color) noexcept { return color == Color_RGB::RAINBOW; };
+      auto const element_color = [&](std::string_view attribute, Color_RGB color, size_type node, Sprite_Category category) -> void {
+        if(is_rainbow(color))
+          out << " " << attribute << "=\"" << trim::rainbow_color(static_cast<std::uint32_t>(node), category) << "\"";
+      };
+      auto const group_color = [&](std::string_view attribute, Color_RGB color) -> void {
+        if(!is_rainbow(color))
+          out << " " << attribute << "=\"" << color << "\"";
+      };
+
+      coord_type const width = (trim::width(scene) + 1) * cell_width;
+      coord_type const height = (trim::height(scene) + 1) * cell_height;
+      out << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << width << "\" height=\"" << height << "\" viewBox=\"0 0 " << width << " " << height << "\">\n";
+
+      // edges go from the bottom of the parent down to the trunk line, along it, then down to the top of the child
+      out << "<g fill=\"none\"";
+      group_color("stroke", style.branch_color);
+      out << ">\n";
+      for(size_type node = 0; node < num_nodes; ++node) {
+        size_type const num_children = tree.num_children(node);
+        if(num_children == 0)
+          continue;
+
+        Point const parent_point = trim::midpoint(trim::bot_segment(layout[node].rect));
+        Point const left_point = trim::midpoint(trim::top_segment(layout[tree.get_child(node, 0)].rect));
+        coord_type const trunk_line = std::midpoint(parent_point.line, left_point.line);
+
+        for(size_type i = 0; i < num_children; ++i) {
+          Point const child_point = trim::midpoint(trim::top_segment(layout[tree.get_child(node, i)].rect));
+          out << "<path d=\"M" << x(parent_point.column) << " " << y(parent_point.line) << "V" << y(trunk_line) << "H" << x(child_point.column)
+              << "V" << y(child_point.line) << "\"";
+          element_color("stroke", style.branch_color, node, Sprite_Category::BRANCH);
+          out << "/>\n";
+        }
+        out.flush_if_full();
+      }
+      out << "</g>\n";
+
+      out << "<g fill=\"none\"";
+      group_color("stroke", style.box_color);
+      out << ">\n";
+      for(size_type node = 0; node < num_nodes; ++node) {
+        Rect const rect = layout[node].rect;
+        out << "<rect x=\"" << x(left_column(rect)) << "\" y=\"" << y(top_line(rect)) << "\" width=\"" << trim::width(rect) * cell_width
+            << "\" height=\"" << trim::height(rect) * cell_height << "\"";
+        element_color("stroke", style.box_color, node, Sprite_Category::NODE);
+        out << "/>\n";
+        out.flush_if_full();
+      }
+      out << "</g>\n";
+
+      // each character of a label takes one cell, as in the text output
+      out << "<g font-family=\"monospace\" font-size=\"" << options.font_size << "\" dominant-baseline=\"central\" xml:space=\"preserve\"";
+      group_color("fill", style.text_color);
+      if(style.text_modifier & Text_Modifier::BOLD)
+        out << " font-weight=\"bold\"";
+      if(style.text_modifier & Text_Modifier::ITALIC)
+        out << " font-style=\"italic\"";
+      if(style.text_modifier & Text_Modifier::UNDERLINE)
+        out << " text-decoration=\"underline\"";
+      out << ">\n";
+      for(size_type node = 0; node < num_nodes; ++node) {
+        Rect const rect = layout[node].rect;
+        Text_Sprite const text = Text_Sprite(node_labels(node), trim::height(rect) - 2, trim::width(rect) - 2);
+
+        out << "<text";
+        element_color("fill", style.text_color, node, Sprite_Category::TEXT);
+        out << ">";
+
+        coord_type index = 0;
+        trim::split_string_by_newline(node_labels(node), [&](std::string_view line) {
+          if(index <= trim::height(rect) - 2 && !line.empty()) {
+            coord_type const column = left_column(rect) + 1 + text.line_offset(style, line);
+            out << "<tspan x=\"" << x(column) - cell_width / 2 << "\" y=\"" << y(top_line(rect) + 1 + index) << "\">";
+            out.text(line);
+            out << "</tspan>";
+          }
+          index += 1;
+        });
+
+        out << "</text>\n";
+        out.flush_if_full();
+      }
+      out << "</g>\n";
+
+      out << "</svg>\n";
+      out.flush();
+    }
+  }
+} // namespace trim
@@ -0,0 +1,213 @@
+#pragma once
+#include <trim/render/ansi.hpp>
+#include <trim/render/byte_buffer.hpp>
+#include <trim/render/canvas.hpp>
+#include <trim/render/sink.hpp>
+#include <trim/sprite/tree.hpp>
+#include <trim/util/geometry.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace trim
+{
+  /*!
+   * Draws a laid out tree row by row, without building the sprites of the whole tree.
+   * The scene is swept from top to bottom: the sprites of a node or branch are built
+   * when its first line is reached and dropped after its last line,
+   * and each row is written as soon as it is complete.
+   * Sprites alive at any time are the ones crossing the current row, roughly one level of the tree.
+   * The nodes and branches are sorted by line once, when the stream is made, so drawing a window only
+   * looks at the levels it covers and drawing the bands of a scene costs about as much as drawing it whole.
+   * The tree, the labels and the layout are not copied, they must outlive the stream.
+   */
+  struct Tree_Stream
+  {
+    private:
+
+    // a node or a branch that starts at a given line
+    struct Event
+    {
+      coord_type line {};
+      size_type key {};
+    };
+
+    // a sprite crossing the current row
+    struct Active_Sprite
+    {
+      size_type key {};
+      coord_type last_line {};
+      Sprite sprite {};
+    };
+
+    Tree const* m_tree {};
+    size_type m_root {};
+    Labels const* m_node_labels {};
+    Tree_Layout const* m_layout {};
+    Tree_Line_Index m_index {};
+
+    public:
+
+    constexpr Tree_Stream(Tree const& tree, size_type root, Labels const& node_labels, Tree_Layout const& layout)
+      : m_tree(&tree)
+      , m_root(root)
+      , m_node_labels(&node_labels)
+      , m_layout(&layout)
+      , m_index(tree, layout)
+    {}
+
+    [[nodiscard]] constexpr Rect rect() const noexcept
+    {
+      return m_layout->rect();
+    }
+
+    [[nodiscard]] constexpr Tree_Line_Index const& line_index() const noexcept
+    {
+      return m_index;
+    }
+
+    template<typename Output>
+    constexpr void draw(Output& output, Style const& style) const
+    {
+      draw(output, style, rect());
+    }
+
+    /*!
+     * Writes the cells inside the window, same as Scene::draw on a Tree_Sprite of the same tree.
+     * Sprites outside the window are never built.
+     */
+    template<typename Output>
+    constexpr void draw(Output& output, Style const& style, Rect window, Ansi_Options const& options = {}) const
+    {
+      draw(output, style, window, Ansi_Markup(options));
+    }
+
+    // same as above, with the colors marked up by another markup than ANSI escapes
+    template<typename Output, Is_Row_Markup Markup>
+    constexpr void draw(Output& output, Style const& style, Rect window, Markup const& markup) const
+    {
+      if constexpr(Is_Sink<Output>) {
+        draw_rows(output, style, window, markup);
+      } else {
+        Stream_Sink<Output> sink = Stream_Sink<Output>(output);
+        draw_rows(sink, style, window, markup);
+      }
+    }
+
+    /*!
+     * The exact number of bytes written by draw() with the same arguments.
+     * The window is swept as by draw(), rows are measured without being written.
+     */
+    [[nodiscard]] constexpr size_type output_size(Style const& style, Rect window, Ansi_Options const& options = {}) const
+    {
+      return output_size(style, window, Ansi_Markup(options));
+    }
+
+    template<Is_Row_Markup Markup>
+    [[nodiscard]] constexpr size_type output_size(Style const& style, Rect window, Markup const& markup) const
+    {
+      Byte_Count count {};
+      sweep(style, window, markup, [&](Row_Encoder<Markup>& encoder, Canvas const& canvas, coord_type line) { encoder.append_row(count, canvas, line); });
+      return count.size;
+    }
+
+    /*!
+     * Returns the output of draw() in a string allocated once, at its exact size.
+     * The window is swept twice, once to measure the rows and once to encode them in place.
+     */
+    [[nodiscard]] constexpr std::string render(Style const& style, Rect window, Ansi_Options const& options = {}) const
+    {
+      return render(style, window, Ansi_Markup(options));
+    }
+
+    template<Is_Row_Markup Markup>
+    [[nodiscard]] constexpr std::string render(Style const& style, Rect window, Markup const& markup) const
+    {
+      std::string result {};
+      result.reserve(output_size(style, window, markup));
+      sweep(style, window, markup, [&](Row_Encoder<Markup>& encoder, Canvas const& canvas, coord_type line) { encoder.append_row(result, canvas, line); });
+      return result;
+    }
+
+    private:
+
+    template<Is_Sink Sink, Is_Row_Markup Markup>
+    constexpr void draw_rows(Sink& sink, Style const& style, Rect window, Markup const& markup) const
+    {
+      std::vector<char> row {};
+      sweep(style, window, markup, [&](Row_Encoder<Markup>& encoder, Canvas const& canvas, coord_type line) {
+        row.clear();
+        encoder.append_row(row, canvas, line);
+        sink.write(std::string_view(row.data(), row.size()));
+      });
+    }
+
+    // rasterizes the rows of the window from top to bottom, on_row(encoder, canvas, line) is called once per row
+    template<Is_Row_Markup Markup, typename On_Row>
+    constexpr void sweep(Style const& style, Rect window, Markup const& markup, On_Row&& on_row) const
+    {
+      Tree const& tree = *m_tree;
+      Tree_Layout const& layout = *m_layout;
+      size_type const num_nodes = tree.size();
+
+      // nodes use keys [0, num_nodes) and branches use [num_nodes, 2 * num_nodes),
+      // sprites are painted in key order, which is the order used by Tree_Sprite
+      std::vector<Event> events {};
+      m_index.visit(window, [&](size_type key, Rect rect) { events.push_back(Event {.line = top_line(rect), .key = key}); });
+
+      std::vector<Active_Sprite> active {};
+      std::vector<Active_Sprite> started {};
+      std::vector<Active_Sprite> merged {};
+      std::vector<Sprite> built {};
+      Canvas canvas {};
+      canvas.set_style(style);
+      Row_Encoder<Markup> encoder = Row_Encoder<Markup>(markup);
+      auto next_event = events.begin();
+
+      // builds the sprites of a node or branch
+      auto const activate = [&](size_type key) -> void {
+        built.clear();
+        if(key < num_nodes) {
+          Tree_Sprite::append_node(built, tree, m_root, *m_node_labels, layout, key);
+        } else {
+          Tree_Sprite::append_branch(built, tree, layout, key - num_nodes);
+        }
+
+        for(Sprite& sprite : built) {
+          coord_type const last_line = bot_line(sprite.rect());
+          started.push_back(Active_Sprite {.key = key, .last_line = last_line, .sprite = std::move(sprite)});
+        }
+      };
+
+      for(coord_type line = top_line(window); line <= bot_line(window); ++line) {
+        // events starting on this line, or above the window on its first line, are built in key order
+        auto const last_event = std::ranges::find_if(next_event, events.end(), [line](Event const& event) noexcept { return event.line > line; });
+        std::ranges::sort(next_event, last_event, {}, &Event::key);
+        for(; next_event != last_event; ++next_event) {
+          activate(next_event->key);
+        }
+
+        // merge the started sprites in one pass over the active ones
+        if(!started.empty()) {
+          merged.clear();
+          std::ranges::merge(active, started, std::back_inserter(merged), {}, &Active_Sprite::key, &Active_Sprite::key);
+          std::swap(active, merged);
+          started.clear();
+        }
+
+        canvas.reset(Rect(Point(line, left_column(window)), Point(line, right_column(window))));
+        for(Active_Sprite const& entry : active) {
+          if(trim::intersects(entry.sprite.rect(), canvas.rect()))
+            entry.sprite.raster(style, canvas, Point::origin);
+        }
+
+        on_row(encoder, canvas, line);
+
+        std::erase_if(active, [line](Active_Sprite const& entry) noexcept { return entry.last_line <= line; });
+      }
+    }
+  };
+} // namespace trim
@@ -1,8 +1,11 @@
 #pragma once
-#include <trim/sprite/sprite.hpp>
+#include <trim/render/canvas.hpp>
+#include <trim/render/stamp.hpp>
+#include <trim/sprite/concept.hpp>
 #include <trim/style/style.hpp>
 #include <trim/util/geometry.hpp>
 #include <trim/util/ints.hpp>
+#include <cstdint>
 #include <type_traits>
 
 namespace trim
@@ -79,11 +82,41 @@ namespace trim
       TRIM_ASSERT(false);
     }
 
+    /*!
+     * Boxes of a tree share a handful of shapes, the frame of each shape is rendered once
+     * into a stamp of the canvas and painted at every box with that shape.
+     */
+    template<Is_Canvas Target>
+    constexpr void raster(Style const& style, Target& canvas, Point origin) const noexcept
+    {
+      if constexpr(Is_Stamp_Canvas<Target>) {
+        if(!trim::intersects(trim::translate(rect(), origin.line, origin.column), canvas.rect()))
+          return;
+
+        Stamp const& stamp = canvas.stamp(stamp_key(), rect(), [&](Stamp_Recorder& recorder) {
+          trim::raster_cells(*this, style, recorder, Point::origin);
+        });
+        canvas.paint(origin, stamp);
+      } else {
+        trim::raster_cells(*this, style, canvas, origin);
+      }
+    }
+
     [[nodiscard]] constexpr Sprite_Category category() const noexcept
     {
       return Sprite_Category::NODE;
     }
+
+    private:
+
+    // the shape of the box, two boxes with the same key have the same cells
+    [[nodiscard]] constexpr std::uint64_t stamp_key() const noexcept
+    {
+      TRIM_ASSERT(height >= 0 && height < (coord_type(1) << 30));
+      TRIM_ASSERT(width >= 0 && width < (coord_type(1) << 30));
+      return (std::uint64_t(height) << 32) | (std::uint64_t(width) << 2) | (std::uint64_t(is_top_connected) << 1) | std::uint64_t(is_bot_connected);
+    }
   };
 
-  static_assert(Is_Sprite<Box_Sprite>);
+  static_assert(Is_Raster_Sprite<Box_Sprite>);
 } // namespace trim
@@ -1,30 +1,29 @@
 #pragma once
-#include <trim/sprite/sprite.hpp>
+#include <trim/sprite/concept.hpp>
 #include <trim/style/style.hpp>
 #include <trim/util/geometry.hpp>
 #include <trim/util/ints.hpp>
-#include <trim/util/string.hpp>
 
 #include <string_view>
 
 namespace trim
 {
+  /*!
+   * Draws a single glyph.
+   * The glyph is not copied, it must outlive the sprite.
+   */
   struct Character_Sprite
   {
     private:
 
-    trim::String m_character {};
+    std::string_view m_character {};
 
     public:
 
     Character_Sprite() = default;
 
-    constexpr Character_Sprite(trim::String character) noexcept
-      : m_character(std::move(character))
-    {}
-
-    constexpr Character_Sprite(std::string_view character)
-      : m_character(trim::String(character))
+    constexpr Character_Sprite(std::string_view character) noexcept
+      : m_character(character)
     {}
 
     [[nodiscard]] constexpr Rect rect() const noexcept
@@ -35,7 +34,7 @@ namespace trim
     [[nodiscard]] constexpr Draw_Result draw([[maybe_unused]] Style const& style, Point cursor) const noexcept
     {
       TRIM_ASSERT(trim::envelopes(rect(), cursor));
-      return Draw_Result {std::string_view(m_character), style.text_color};
+      return Draw_Result {m_character, style.text_color};
     }
 
     [[nodiscard]] constexpr Sprite_Category category() const noexcept
@@ -1,34 +1,45 @@
 #pragma once
+#include <trim/container/rect_grid.hpp>
 #include <trim/sprite/sprite.hpp>
 
+#include <ranges>
+#include <span>
 #include <vector>
 
 namespace trim
 {
   struct Composite_Sprite
   {
+    // composites with more sprites than this get a spatial index for point queries
+    static constexpr size_type grid_threshold = 16;
+
     private:
 
     std::vector<Sprite> m_sprites {};
     Rect m_rect {};
     Sprite_Category m_category {};
+    Rect_Grid m_grid {};
 
     public:
 
     Composite_Sprite() = default;
 
-    template<typename T>
-      requires(!std::is_same_v<T, Composite_Sprite> && Is_Sprite<T>)
-    explicit constexpr Composite_Sprite(T sprite)
+    explicit constexpr Composite_Sprite(Sprite sprite)
       : m_sprites()
       , m_rect()
       , m_category()
     {
-      m_sprites.push_back(Sprite(std::move(sprite)));
+      m_sprites.push_back(std::move(sprite));
       m_rect = m_sprites[0].rect();
       m_category = m_sprites[0].category();
     }
 
+    template<typename T>
+      requires(!std::is_same_v<T, Composite_Sprite> && Is_Sprite_Group<T>)
+    explicit constexpr Composite_Sprite(T const& group)
+      : Composite_Sprite(flatten(group))
+    {}
+
     explicit constexpr Composite_Sprite(std::vector<Sprite> sprites) noexcept
       : m_sprites(std::move(sprites))
       , m_rect()
@@ -49,6 +60,14 @@ namespace trim
       }
 
       m_rect = Rect(Point(min_line, min_col), Point(max_line, max_col));
+
+      if(m_sprites.size() > grid_threshold) {
+        std::vector<Rect> rects {};
+        rects.reserve(m_sprites.size());
+        for(Sprite const& s : m_sprites)
+          rects.push_back(s.rect());
+        m_grid = Rect_Grid(rects, m_rect);
+      }
     }
 
     [[nodiscard]] constexpr Rect rect() const noexcept
@@ -60,26 +79,70 @@ namespace trim
     {
       TRIM_ASSERT(envelopes(rect(), cursor));
 
-      // TODO: improve time complexity
+      // the last sprite with a non-empty result wins, so search backwards and stop at the first hit
+      auto const draw_last = [&](auto const& indices) -> Draw_Result {
+        for(size_type index : indices | std::views::reverse) {
+          Sprite const& sprite = m_sprites[index];
+          if(!trim::envelopes(sprite.rect(), cursor))
+            continue;
 
-      Draw_Result result {};
-      for(Sprite const& sprite : m_sprites) {
-        if(!trim::envelopes(sprite.rect(), cursor))
-          continue;
+          Draw_Result curr = sprite.draw(style, cursor);
+          if(!curr.empty())
+            return curr;
+        }
 
-        Draw_Result curr = sprite.draw(style, cursor);
-        if(curr.character != "")
-          result = curr;
+        return Draw_Result {};
+      };
+
+      if(m_grid.empty()) {
+        return draw_last(std::views::iota(size_type(0), m_sprites.size()));
       }
 
-      return result;
+      return draw_last(m_grid.query(cursor));
+    }
+
+    template<Is_Canvas Target>
+    constexpr void raster(Style const& style, Target& canvas, Point origin) const noexcept
+    {
+      Rect const rect = trim::translate(m_rect, origin.line, origin.column);
+      if(!trim::intersects(rect, canvas.rect()))
+        return;
+
+      // later sprites overwrite earlier ones, same as draw()
+      for(Sprite const& sprite : m_sprites) {
+        if(trim::intersects(trim::translate(sprite.rect(), origin.line, origin.column), canvas.rect()))
+          sprite.raster(style, canvas, origin);
+      }
     }
 
     [[nodiscard]] constexpr Sprite_Category category() const noexcept
     {
       return m_category;
     }
+
+    [[nodiscard]] constexpr std::span<Sprite const> sprites() const noexcept
+    {
+      return m_sprites;
+    }
+
+    constexpr void append_to(std::vector<Sprite>& sprites, coord_type lines, coord_type columns) const
+    {
+      for(Sprite const& sprite : m_sprites) {
+        sprites.push_back(trim::translate(sprite, lines, columns));
+      }
+    }
+
+    private:
+
+    template<Is_Sprite_Group T>
+    [[nodiscard]] static constexpr std::vector<Sprite> flatten(T const& group)
+    {
+      std::vector<Sprite> sprites {};
+      group.append_to(sprites, 0, 0);
+      return sprites;
+    }
   };
 
-  static_assert(Is_Sprite<Composite_Sprite>);
+  static_assert(Is_Raster_Sprite<Composite_Sprite>);
+  static_assert(Is_Sprite_Group<Composite_Sprite>);
 } // namespace trim
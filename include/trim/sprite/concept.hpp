@@ -0,0 +1,53 @@
+#pragma once
+#include <trim/render/canvas.hpp>
+#include <trim/sprite/draw_result.hpp>
+#include <trim/style/style.hpp>
+#include <trim/util/geometry.hpp>
+#include <trim/util/ints.hpp>
+
+#include <concepts>
+
+namespace trim
+{
+  // clang-format off
+
+  enum class Sprite_Category
+  {
+    NONE    = 0b0000,
+    NODE    = 0b0001,
+    BRANCH  = 0b0010,
+    TEXT    = 0b0100,
+  };
+
+  // clang-format on
+
+  [[nodiscard]] constexpr bool operator&(Sprite_Category lhs, Sprite_Category rhs) noexcept
+  {
+    return static_cast<bool>(static_cast<unsigned>(lhs) & static_cast<unsigned>(rhs));
+  }
+
+  [[nodiscard]] constexpr Sprite_Category operator|(Sprite_Category lhs, Sprite_Category rhs) noexcept
+  {
+    return Sprite_Category(static_cast<unsigned>(lhs) | static_cast<unsigned>(rhs));
+  }
+
+  template<typename T>
+  concept Is_Sprite = requires(T const& sprite, Point cursor, Style const& style) {
+    // clang-format off
+    { sprite.rect() } noexcept -> std::same_as<Rect>;
+    { sprite.draw(style, cursor) } noexcept -> std::same_as<Draw_Result>;
+    { sprite.category() } noexcept -> std::same_as<Sprite_Category>;
+    // clang-format on
+  };
+
+  /*!
+   * A sprite that paints all of its cells into a canvas in one pass,
+   * instead of being queried cell by cell.
+   */
+  template<typename T>
+  concept Is_Raster_Sprite = Is_Sprite<T> && requires(T const& sprite, Style const& style, Canvas& canvas, Point origin) {
+    // clang-format off
+    { sprite.raster(style, canvas, origin) } noexcept;
+    // clang-format on
+  };
+} // namespace trim
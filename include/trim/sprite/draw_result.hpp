@@ -0,0 +1,29 @@
+#pragma once
+#include <trim/color/rgb.hpp>
+
+#include <compare>
+#include <string_view>
+
+namespace trim
+{
+  struct Draw_Result
+  {
+    std::string_view character {};
+    Color_RGB color {};
+
+    Draw_Result() = default;
+
+    explicit constexpr Draw_Result(std::string_view character, Color_RGB color) noexcept
+      : character(character)
+      , color(color)
+    {}
+
+    [[nodiscard]] constexpr bool empty() const noexcept
+    {
+      return character.empty();
+    }
+
+    bool operator==(Draw_Result const&) const = default;
+    auto operator<=>(Draw_Result const&) const = default;
+  };
+} // namespace trim
@@ -1,5 +1,5 @@
 #pragma once
-#include <trim/sprite/sprite.hpp>
+#include <trim/sprite/concept.hpp>
 #include <trim/style/style.hpp>
 #include <trim/util/geometry.hpp>
 
@@ -1,53 +1,68 @@
 #pragma once
 #include <trim/sprite/box.hpp>
-#include <trim/sprite/composite.hpp>
 #include <trim/sprite/sprite.hpp>
 #include <trim/sprite/text.hpp>
-#include <trim/sprite/transform.hpp>
 
 #include <string_view>
 #include <vector>
 
 namespace trim
 {
+  /*!
+   * A box with a label inside.
+   * The label is not copied, it must outlive the sprite.
+   */
   struct Node_Sprite
   {
     private:
 
-    Composite_Sprite m_composite {};
+    Box_Sprite m_box {};
+    Text_Sprite m_text {};
 
     public:
 
     Node_Sprite() = default;
 
-    constexpr Node_Sprite(coord_type height, coord_type width, bool is_top_connected, bool is_bot_connected, std::string_view text)
-      : m_composite()
-    {
-      std::vector<Sprite> sprites {};
-
-      Sprite box_sprite = Box_Sprite(height, width, is_top_connected, is_bot_connected);
-      Sprite text_sprite = Text_Sprite(text, height - 2, width - 2);
-      sprites.push_back(Translate_Sprite(std::move(text_sprite), 1, 1));
-      sprites.push_back(std::move(box_sprite));
-      m_composite = Composite_Sprite(std::move(sprites));
-    }
+    constexpr Node_Sprite(coord_type height, coord_type width, bool is_top_connected, bool is_bot_connected, std::string_view text) noexcept
+      : m_box(height, width, is_top_connected, is_bot_connected)
+      , m_text(text, height - 2, width - 2)
+    {}
 
     [[nodiscard]] constexpr Rect rect() const noexcept
     {
-      return m_composite.rect();
+      return m_box.rect();
     }
 
     [[nodiscard]] constexpr Draw_Result draw(Style const& style, Point cursor) const noexcept
     {
       TRIM_ASSERT(trim::envelopes(rect(), cursor));
-      return m_composite.draw(style, cursor);
+
+      // the box is drawn over the text
+      if(Draw_Result box = m_box.draw(style, cursor); !box.empty())
+        return box;
+
+      return m_text.draw(style, trim::translate(cursor, -1, -1));
+    }
+
+    template<Is_Canvas Target>
+    constexpr void raster(Style const& style, Target& canvas, Point origin) const noexcept
+    {
+      m_text.raster(style, canvas, trim::translate(origin, 1, 1));
+      m_box.raster(style, canvas, origin);
     }
 
     [[nodiscard]] constexpr Sprite_Category category() const noexcept
     {
       return Sprite_Category::NODE | Sprite_Category::TEXT;
     }
+
+    constexpr void append_to(std::vector<Sprite>& sprites, coord_type lines, coord_type columns) const
+    {
+      sprites.push_back(Sprite(m_text, Point(lines + 1, columns + 1)));
+      sprites.push_back(Sprite(m_box, Point(lines, columns)));
+    }
   };
 
-  static_assert(Is_Sprite<Node_Sprite>);
+  static_assert(Is_Raster_Sprite<Node_Sprite>);
+  static_assert(Is_Sprite_Group<Node_Sprite>);
 } // namespace trim
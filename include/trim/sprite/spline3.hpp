@@ -1,25 +1,28 @@
 #pragma once
-#include <trim/sprite/character.hpp>
-#include <trim/sprite/composite.hpp>
 #include <trim/sprite/joint.hpp>
 #include <trim/sprite/line.hpp>
 #include <trim/sprite/sprite.hpp>
-#include <trim/sprite/transform.hpp>
 #include <trim/style/style.hpp>
 #include <trim/util/geometry.hpp>
 
+#include <array>
+#include <ranges>
+#include <vector>
+
 namespace trim
 {
   struct Spline3_Sprite
   {
     private:
 
-    Composite_Sprite m_composite {};
+    std::array<Sprite, 5> m_sprites {};
+    Rect m_rect {};
 
     public:
 
     constexpr Spline3_Sprite(Point p1, Point p2, Point p3, bool ignore_start = 0, bool ignore_end = 0) noexcept
-      : m_composite()
+      : m_sprites()
+      , m_rect()
     {
       TRIM_ASSERT(p1.line == 0 || p1.column == 0);
       TRIM_ASSERT(p2.line == p1.line || p2.column == p1.column);
@@ -27,8 +30,6 @@ namespace trim
       TRIM_ASSERT(p1 != p2);
       TRIM_ASSERT(p2 != p3);
 
-      std::vector<Sprite> sprites {};
-
       // returns either a vertical line or a horizontal line
       auto const make_line_sprite = [](Point p, bool ignore_start, bool ignore_end) -> Sprite {
         switch(trim::axis(Point::origin, p)) {
@@ -57,30 +58,57 @@ namespace trim
       Sprite l3 = make_line_sprite(trim::translate(p3, -p2.line, -p2.column), true, ignore_end);
       Sprite join1 = get_join_character(Point::origin, p1, p2);
       Sprite join2 = get_join_character(p1, p2, p3);
-      sprites.push_back(std::move(l1));
-      sprites.push_back(Translate_Sprite(std::move(l2), p1.line, p1.column));
-      sprites.push_back(Translate_Sprite(std::move(l3), p2.line, p2.column));
-      sprites.push_back(Translate_Sprite(std::move(join1), p1.line, p1.column));
-      sprites.push_back(Translate_Sprite(std::move(join2), p2.line, p2.column));
-      m_composite = Composite_Sprite(std::move(sprites));
+      m_sprites[0] = std::move(l1);
+      m_sprites[1] = trim::translate(std::move(l2), p1.line, p1.column);
+      m_sprites[2] = trim::translate(std::move(l3), p2.line, p2.column);
+      m_sprites[3] = trim::translate(std::move(join1), p1.line, p1.column);
+      m_sprites[4] = trim::translate(std::move(join2), p2.line, p2.column);
+
+      m_rect = m_sprites[0].rect();
+      for(Sprite const& sprite : m_sprites)
+        m_rect = trim::minumum_bounding_box(m_rect, sprite.rect());
     }
 
     [[nodiscard]] constexpr Rect rect() const noexcept
     {
-      return m_composite.rect();
+      return m_rect;
     }
 
     [[nodiscard]] constexpr Draw_Result draw(Style const& style, Point cursor) const noexcept
     {
       TRIM_ASSERT(trim::envelopes(rect(), cursor));
-      return m_composite.draw(style, cursor);
+
+      // the last sprite with a non-empty result wins
+      for(Sprite const& sprite : m_sprites | std::views::reverse) {
+        if(!trim::envelopes(sprite.rect(), cursor))
+          continue;
+
+        if(Draw_Result result = sprite.draw(style, cursor); !result.empty())
+          return result;
+      }
+
+      return Draw_Result {};
+    }
+
+    template<Is_Canvas Target>
+    constexpr void raster(Style const& style, Target& canvas, Point origin) const noexcept
+    {
+      for(Sprite const& sprite : m_sprites)
+        sprite.raster(style, canvas, origin);
     }
 
     [[nodiscard]] constexpr Sprite_Category category() const noexcept
     {
       return Sprite_Category::BRANCH;
     }
+
+    constexpr void append_to(std::vector<Sprite>& sprites, coord_type lines, coord_type columns) const
+    {
+      for(Sprite const& sprite : m_sprites)
+        sprites.push_back(trim::translate(sprite, lines, columns));
+    }
   };
 
-  static_assert(Is_Sprite<Spline3_Sprite>);
+  static_assert(Is_Raster_Sprite<Spline3_Sprite>);
+  static_assert(Is_Sprite_Group<Spline3_Sprite>);
 } // namespace trim
@@ -1,164 +1,174 @@
 #pragma once
-#include "trim/color/rgb.hpp"
+#include <trim/render/canvas.hpp>
+#include <trim/sprite/box.hpp>
+#include <trim/sprite/character.hpp>
+#include <trim/sprite/concept.hpp>
+#include <trim/sprite/joint.hpp>
+#include <trim/sprite/line.hpp>
+#include <trim/sprite/text.hpp>
 #include <trim/style/style.hpp>
 #include <trim/util/geometry.hpp>
 #include <trim/util/ints.hpp>
-#include <trim/util/unique_ptr.hpp>
 
-#include <string_view>
+#include <cstdint>
+#include <type_traits>
+#include <variant>
+#include <vector>
 
 namespace trim
 {
-  // clang-format off
-
-  enum class Sprite_Category
-  {
-    NONE    = 0b0000,
-    NODE    = 0b0001,
-    BRANCH  = 0b0010,
-    TEXT    = 0b0100,
-  };
-
-  // clang-format on
-
-  [[nodiscard]] constexpr bool operator&(Sprite_Category lhs, Sprite_Category rhs) noexcept
+  /*!
+   * The rainbow color of the sprites of a category owned by a node.
+   * The color only depends on its arguments, so output is the same on every run.
+   */
+  [[nodiscard]] constexpr Color_RGB rainbow_color(std::uint32_t owner, Sprite_Category category) noexcept
   {
-    return static_cast<bool>(static_cast<unsigned>(lhs) & static_cast<unsigned>(rhs));
+    std::uint_least64_t const seed = (std::uint_least64_t(owner) << 4) | static_cast<unsigned>(category);
+    return pick_rainbow(seed);
   }
 
-  [[nodiscard]] constexpr Sprite_Category operator|(Sprite_Category lhs, Sprite_Category rhs) noexcept
-  {
-    return Sprite_Category(static_cast<unsigned>(lhs) | static_cast<unsigned>(rhs));
-  }
-
-  struct Draw_Result
+  /*!
+   * A primitive sprite placed at an origin.
+   * The set of primitives is closed, they are stored inline in a variant,
+   * so a sprite never allocates and dispatch happens without virtual calls.
+   * Sprites made of several primitives (nodes, splines, trees) append their
+   * primitives to a flat std::vector<Sprite> instead of nesting.
+   */
+  struct Sprite
   {
-    std::string_view character {};
-    Color_RGB color {};
+    using variant_type = std::variant< //
+      Box_Sprite,
+      Text_Sprite,
+      Character_Sprite,
+      Horizontal_Line_Sprite,
+      Vertical_Line_Sprite,
+      Joint_Sprite>;
 
-    Draw_Result() = default;
+    private:
 
-    explicit constexpr Draw_Result(std::string_view character, Color_RGB color) noexcept
-      : character(character)
-      , color(color)
-    {}
+    variant_type m_value {};
+    Point m_origin {};
+    std::uint32_t m_owner {};
 
-    bool operator==(Draw_Result const&) const = default;
-    auto operator<=>(Draw_Result const&) const = default;
-  };
+    public:
 
-  template<typename T>
-  concept Is_Sprite = requires(T const& sprite, Point cursor, Style const& style) {
-    // clang-format off
-    { sprite.rect() } noexcept -> std::same_as<Rect>;
-    { sprite.draw(style, cursor) } noexcept -> std::same_as<Draw_Result>;
-    { sprite.category() } noexcept -> std::same_as<Sprite_Category>;
-    // clang-format on
-  };
+    Sprite() = default;
 
-  struct Sprite
-  {
-    private:
+    template<typename T>
+      requires(std::is_constructible_v<variant_type, T> && Is_Sprite<T>)
+    constexpr Sprite(T init, Point origin = Point::origin) noexcept
+      : m_value(std::move(init))
+      , m_origin(origin)
+    {}
 
-    struct Interface
+    [[nodiscard]] constexpr Point origin() const noexcept
     {
-      [[nodiscard]] constexpr virtual Rect rect() const noexcept = 0;
-      [[nodiscard]] constexpr virtual Draw_Result draw(Style const& style, Point cursor) const noexcept = 0;
-      [[nodiscard]] constexpr virtual Sprite_Category category() const noexcept = 0;
-
-      virtual constexpr ~Interface() noexcept
-      {}
-    };
+      return m_origin;
+    }
 
-    template<Is_Sprite T>
-    struct Storage final : Interface
+    // the node the sprite belongs to, rainbow styles pick one color per owner
+    [[nodiscard]] constexpr std::uint32_t owner() const noexcept
     {
-      T m_value {};
+      return m_owner;
+    }
 
-      Storage() = default;
+    constexpr void set_owner(std::uint32_t owner) noexcept
+    {
+      m_owner = owner;
+    }
 
-      constexpr Storage(T const& init)                    //
-        noexcept(std::is_nothrow_copy_constructible_v<T>) //
-        requires(std::is_copy_constructible_v<T>)         //
-        : m_value(init)
-      {}
+    [[nodiscard]] constexpr Rect rect() const noexcept
+    {
+      Rect const rect = std::visit([](auto const& value) noexcept { return value.rect(); }, m_value);
+      return trim::translate(rect, m_origin.line, m_origin.column);
+    }
 
-      constexpr Storage(T&& init)                         //
-        noexcept(std::is_nothrow_move_constructible_v<T>) //
-        requires(std::is_move_constructible_v<T>)         //
-        : m_value(std::move(init))
-      {}
+    [[nodiscard]] constexpr Draw_Result draw(Style const& style, Point cursor) const noexcept
+    {
+      Point const local = trim::translate(cursor, -m_origin.line, -m_origin.column);
+      Draw_Result result = std::visit([&](auto const& value) noexcept { return value.draw(style, local); }, m_value);
 
-      [[nodiscard]] constexpr Rect rect() const noexcept override
-      {
-        return m_value.rect();
+      if(is_rainbow(style)) {
+        result.color = rainbow_color();
       }
 
-      [[nodiscard]] constexpr Draw_Result draw(Style const& style, Point cursor) const noexcept override
-      {
-        Draw_Result result = m_value.draw(style, cursor);
-
-        Sprite_Category const cat = m_value.category();
+      return result;
+    }
 
-        auto const pick_color = [&]() -> Color_RGB {
-          std::size_t seed = 42;
-          seed ^= trim::splitmix64(static_cast<unsigned>(cat));
-          seed ^= trim::splitmix64(static_cast<std::uint_least64_t>(cursor.line));
-          seed ^= trim::splitmix64(static_cast<std::uint_least64_t>(cursor.column));
-          if(!std::is_constant_evaluated()) {
-            seed ^= trim::splitmix64(std::uintptr_t(&m_value));
-          }
-          return pick_rainbow(seed);
-        };
+    template<Is_Canvas Target>
+    constexpr void raster(Style const& style, Target& canvas, Point origin) const noexcept
+    {
+      Point const sprite_origin = trim::translate(origin, m_origin.line, m_origin.column);
+      auto const raster_value = [&](auto& target) -> void {
+        std::visit(
+          [&](auto const& value) noexcept {
+            if constexpr(Is_Raster_Sprite<std::remove_cvref_t<decltype(value)>>) {
+              value.raster(style, target, sprite_origin);
+            } else {
+              trim::raster_cells(value, style, target, sprite_origin);
+            }
+          },
+          m_value);
+      };
+
+      if(is_rainbow(style)) {
+        Tinted_Canvas<Target> tinted = Tinted_Canvas<Target>(canvas, rainbow_color());
+        raster_value(tinted);
+      } else {
+        raster_value(canvas);
+      }
+    }
 
-        if(cat == Sprite_Category::BRANCH && style.branch_color == Color_RGB::RAINBOW) {
-          result.color = pick_color();
-        }
+    [[nodiscard]] constexpr Sprite_Category category() const noexcept
+    {
+      return std::visit([](auto const& value) noexcept { return value.category(); }, m_value);
+    }
 
-        if(cat == Sprite_Category::NODE && style.box_color == Color_RGB::RAINBOW) {
-          result.color = pick_color();
-        }
+    [[nodiscard]] friend constexpr Sprite translate(Sprite sprite, coord_type lines, coord_type columns) noexcept
+    {
+      sprite.m_origin = trim::translate(sprite.m_origin, lines, columns);
+      return sprite;
+    }
 
-        if(cat == Sprite_Category::TEXT && style.text_color == Color_RGB::RAINBOW) {
-          result.color = pick_color();
-        }
+    private:
 
-        return result;
-      }
+    // the color of every cell of the sprite in rainbow styles, the same on every run
+    [[nodiscard]] constexpr Color_RGB rainbow_color() const noexcept
+    {
+      return trim::rainbow_color(m_owner, category());
+    }
 
-      [[nodiscard]] constexpr Sprite_Category category() const noexcept override
-      {
-        return m_value.category();
-      }
-    };
+    // returns true if this sprite overrides the color of its cells with the rainbow effect
+    [[nodiscard]] constexpr bool is_rainbow(Style const& style) const noexcept
+    {
+      Sprite_Category const cat = category();
 
-    Unique_Ptr<Interface> m_ptr {};
+      if(cat == Sprite_Category::BRANCH && style.branch_color == Color_RGB::RAINBOW)
+        return true;
 
-    public:
+      if(cat == Sprite_Category::NODE && style.box_color == Color_RGB::RAINBOW)
+        return true;
 
-    Sprite() = default;
+      if(cat == Sprite_Category::TEXT && style.text_color == Color_RGB::RAINBOW)
+        return true;
 
-    template<typename T>
-      requires(!std::is_same_v<T, Sprite> && Is_Sprite<T>)
-    constexpr Sprite(T init)                            //
-      noexcept(std::is_nothrow_move_constructible_v<T>) //
-      requires(std::is_move_constructible_v<T>)         //
-      : m_ptr(make_unique<Storage<T>>(std::move(init)))
-    {}
-
-    [[nodiscard]] constexpr Rect rect() const noexcept
-    {
-      return m_ptr->rect();
+      return false;
     }
+  };
 
-    [[nodiscard]] constexpr Draw_Result draw(Style const& style, Point cursor) const noexcept
-    {
-      return m_ptr->draw(style, cursor);
-    }
+  // makes the hidden friend visible to qualified lookup (trim::translate)
+  [[nodiscard]] constexpr Sprite translate(Sprite sprite, coord_type lines, coord_type columns) noexcept;
 
-    [[nodiscard]] constexpr Sprite_Category category() const noexcept
-    {
-      return m_ptr->category();
-    }
+  static_assert(Is_Raster_Sprite<Sprite>);
+
+  /*!
+   * A sprite made of several primitives.
+   * append_to() adds its primitives, translated by (lines, columns), to a flat list.
+   */
+  template<typename T>
+  concept Is_Sprite_Group = Is_Sprite<T> && requires(T const& group, std::vector<Sprite>& sprites, coord_type lines, coord_type columns) {
+    // clang-format off
+    { group.append_to(sprites, lines, columns) };
+    // clang-format on
   };
 } // namespace trim
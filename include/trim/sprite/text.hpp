@@ -1,22 +1,23 @@
 #pragma once
-#include <trim/sprite/sprite.hpp>
+#include <trim/sprite/concept.hpp>
 #include <trim/style/style.hpp>
 #include <trim/util/geometry.hpp>
 #include <trim/util/ints.hpp>
 #include <trim/util/split.hpp>
-#include <trim/util/string.hpp>
 
-#include <string>
 #include <string_view>
-#include <vector>
 
 namespace trim
 {
+  /*!
+   * Draws a multi-line label.
+   * The text is not copied, it must outlive the sprite.
+   */
   struct Text_Sprite
   {
     private:
 
-    std::vector<trim::String> m_lines {};
+    std::string_view m_text {};
     coord_type m_height {};
     coord_type m_width {};
 
@@ -24,15 +25,11 @@ namespace trim
 
     Text_Sprite() = default;
 
-    constexpr Text_Sprite(std::string_view text, coord_type height, coord_type width)
-      : m_lines()
+    constexpr Text_Sprite(std::string_view text, coord_type height, coord_type width) noexcept
+      : m_text(text)
       , m_height(height)
       , m_width(width)
-    {
-      trim::split_string_by_newline(text, [&](std::string_view line) {
-        m_lines.push_back(trim::String(line));
-      });
-    }
+    {}
 
     [[nodiscard]] constexpr Rect rect() const noexcept
     {
@@ -42,60 +39,78 @@ namespace trim
     [[nodiscard]] constexpr Draw_Result draw(Style const& style, Point cursor) const noexcept
     {
       TRIM_ASSERT(trim::envelopes(rect(), cursor));
-      coord_type const num_lines = m_lines.size();
 
       // TODO: implement vertical alignment
 
-      if(cursor.line >= num_lines)
-        return {};
+      coord_type index = 0;
+      Draw_Result result {};
+      trim::split_string_by_newline(m_text, [&](std::string_view line) {
+        if(index == cursor.line)
+          result = draw_line(style, line, cursor.column);
+        index += 1;
+      });
 
-      std::string_view line = std::string_view(m_lines[cursor.line]);
+      return result;
+    }
 
-      switch(style.text_align) {
-        case Text_Alignment::NONE:
-        case Text_Alignment::LEFT: {
-          if(cursor.column < style.node_horizontal_padding)
-            return {};
-          coord_type index = cursor.column - style.node_horizontal_padding;
-          std::string_view character = (index < coord_type(line.size()) ? std::string_view(line.data() + index, 1) : "");
-          return Draw_Result {character, style.text_color};
+    template<Is_Canvas Target>
+    constexpr void raster(Style const& style, Target& canvas, Point origin) const noexcept
+    {
+      coord_type index = 0;
+      trim::split_string_by_newline(m_text, [&](std::string_view line) {
+        if(index <= m_height) {
+          for(coord_type column = 0; column <= m_width; ++column) {
+            canvas.paint(trim::translate(origin, index, column), draw_line(style, line, column));
+          }
         }
+        index += 1;
+      });
+    }
 
-        case Text_Alignment::CENTER: {
-          if(cursor.column < style.node_horizontal_padding)
-            return {};
-          coord_type max_width = (m_width + 1) - style.node_horizontal_padding * 2;
-          coord_type margin = max_width - line.size();
-          if(cursor.column - style.node_horizontal_padding < (margin / 2))
-            return {};
-
-          coord_type index = cursor.column - style.node_horizontal_padding - (margin / 2);
-          std::string_view character = index < coord_type(line.size()) ? std::string_view(line.data() + index, 1) : "";
-          return Draw_Result {character, style.text_color};
-        }
+    [[nodiscard]] constexpr Sprite_Category category() const noexcept
+    {
+      return Sprite_Category::TEXT;
+    }
 
-        case Text_Alignment::RIGHT: {
-          if(cursor.column < style.node_horizontal_padding)
-            return {};
-          coord_type max_width = (m_width + 1) - style.node_horizontal_padding * 2;
-          coord_type margin = max_width - line.size();
-          if(cursor.column - style.node_horizontal_padding < margin)
-            return {};
-
-          coord_type index = cursor.column - style.node_horizontal_padding - margin;
-          std::string_view character = index < coord_type(line.size()) ? std::string_view(line.data() + index, 1) : "";
-          return Draw_Result {character, style.text_color};
-        }
-      }
+    private:
 
-      TRIM_ASSERT(false);
+    [[nodiscard]] constexpr Draw_Result draw_line(Style const& style, std::string_view line, coord_type column) const noexcept
+    {
+      if(column < style.node_horizontal_padding)
+        return {};
+
+      coord_type const index = column - line_offset(style, line);
+      if(index < 0)
+        return {};
+
+      std::string_view character = index < coord_type(line.size()) ? std::string_view(line.data() + index, 1) : "";
+      return Draw_Result {character, style.text_color};
     }
 
-    [[nodiscard]] constexpr Sprite_Category category() const noexcept
+    public:
+
+    /*!
+     * The column of the first character of a line of the label, relative to the sprite.
+     * Characters left of the horizontal padding are not drawn.
+     */
+    [[nodiscard]] constexpr coord_type line_offset(Style const& style, std::string_view line) const noexcept
     {
-      return Sprite_Category::TEXT;
+      coord_type const max_width = (m_width + 1) - style.node_horizontal_padding * 2;
+      coord_type const margin = max_width - coord_type(line.size());
+
+      switch(style.text_align) {
+        case Text_Alignment::NONE:
+        case Text_Alignment::LEFT:
+          return style.node_horizontal_padding;
+        case Text_Alignment::CENTER:
+          return style.node_horizontal_padding + margin / 2;
+        case Text_Alignment::RIGHT:
+          return style.node_horizontal_padding + margin;
+      }
+
+      TRIM_ASSERT(false);
     }
   };
 
-  static_assert(Is_Sprite<Text_Sprite>);
+  static_assert(Is_Raster_Sprite<Text_Sprite>);
 } // namespace trim
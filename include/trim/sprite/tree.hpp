@@ -5,7 +5,6 @@
 #include <trim/sprite/node.hpp>
 #include <trim/sprite/spline3.hpp>
 #include <trim/sprite/sprite.hpp>
-#include <trim/sprite/transform.hpp>
 #include <trim/style/style.hpp>
 #include <trim/util/geometry.hpp>
 
@@ -13,8 +12,146 @@
 #include <trim/container/tree.hpp>
 #include <trim/layout/tree_layout.hpp>
 
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
 namespace trim
 {
+  namespace detail
+  {
+    // the bounding box of the branch from a node to its children, see Tree_Sprite::branch_rect
+    [[nodiscard]] constexpr Rect branch_rect(Tree const& tree, Tree_Layout const& layout, size_type node) noexcept
+    {
+      TRIM_ASSERT(tree.num_children(node) > 0);
+      Point const parent_point = trim::midpoint(trim::bot_segment(layout[node].rect));
+      Rect result = Rect(parent_point, parent_point);
+      for(size_type i = 0; i < tree.num_children(node); ++i) {
+        Point const child_point = trim::midpoint(trim::top_segment(layout[tree.get_child(node, i)].rect));
+        result = trim::minumum_bounding_box(result, Rect(child_point, child_point));
+      }
+      return result;
+    }
+  } // namespace detail
+
+  /*!
+   * The nodes and branches of a laid out tree, sorted by the line they start on.
+   * Keys [0, num_nodes) are the nodes, and num_nodes + node is the branch from a node to its children.
+   * Nodes of a level share their lines, and so do the branches below them, so the events starting on the
+   * lines of a window, or at most the height of the tallest event above it, are the ones of the levels the
+   * window covers. The index is a counting sort of the first lines, linear in the tree and the height of the layout.
+   * The tree and the layout are not copied, they must outlive the index.
+   */
+  struct Tree_Line_Index
+  {
+    private:
+
+    Tree const* m_tree {};
+    Tree_Layout const* m_layout {};
+    coord_type m_top_line {};
+    // the most lines below its first line an event spans
+    coord_type m_max_extent {};
+    // the events starting on line m_top_line + i are m_keys[m_line_begin[i], m_line_begin[i + 1]), by key
+    std::vector<size_type> m_keys {};
+    std::vector<size_type> m_line_begin {};
+
+    public:
+
+    Tree_Line_Index() = default;
+
+    constexpr Tree_Line_Index(Tree const& tree, Tree_Layout const& layout)
+      : m_tree(&tree)
+      , m_layout(&layout)
+      , m_top_line()
+      , m_max_extent()
+      , m_keys()
+      , m_line_begin(1, 0)
+    {
+      size_type const num_nodes = tree.size();
+      if(num_nodes == 0)
+        return;
+
+      // first lines of the events, leaves have no branch
+      std::vector<coord_type> first_lines = std::vector<coord_type>(2 * num_nodes, 0);
+      std::vector<bool> has_branch = std::vector<bool>(num_nodes, false);
+      m_top_line = top_line(layout[0].rect);
+      coord_type bottom_line = m_top_line;
+
+      auto const add = [&](size_type key, Rect rect) -> void {
+        first_lines[key] = top_line(rect);
+        m_top_line = std::min(m_top_line, top_line(rect));
+        bottom_line = std::max(bottom_line, top_line(rect));
+        m_max_extent = std::max(m_max_extent, bot_line(rect) - top_line(rect));
+      };
+
+      for(size_type node = 0; node < num_nodes; ++node) {
+        add(node, layout[node].rect);
+        if(tree.num_children(node) > 0) {
+          has_branch[node] = true;
+          add(num_nodes + node, detail::branch_rect(tree, layout, node));
+        }
+      }
+
+      // keys are counted then placed in increasing order, so the events of a line are sorted by key
+      m_line_begin.assign(static_cast<size_type>(bottom_line - m_top_line) + 2, 0);
+      for(size_type key = 0; key < 2 * num_nodes; ++key) {
+        if(key < num_nodes || has_branch[key - num_nodes])
+          m_line_begin[static_cast<size_type>(first_lines[key] - m_top_line) + 1] += 1;
+      }
+      for(size_type i = 1; i < m_line_begin.size(); ++i)
+        m_line_begin[i] += m_line_begin[i - 1];
+
+      m_keys.resize(m_line_begin.back());
+      std::vector<size_type> next = std::vector<size_type>(m_line_begin.begin(), m_line_begin.end() - 1);
+      for(size_type key = 0; key < 2 * num_nodes; ++key) {
+        if(key < num_nodes || has_branch[key - num_nodes])
+          m_keys[next[static_cast<size_type>(first_lines[key] - m_top_line)]++] = key;
+      }
+    }
+
+    [[nodiscard]] constexpr size_type num_events() const noexcept
+    {
+      return m_keys.size();
+    }
+
+    // the rect of the node or branch of a key
+    [[nodiscard]] constexpr Rect rect(size_type key) const noexcept
+    {
+      size_type const num_nodes = m_tree->size();
+      return key < num_nodes ? (*m_layout)[key].rect : detail::branch_rect(*m_tree, *m_layout, key - num_nodes);
+    }
+
+    /*!
+     * Calls visit(key, rect) for the nodes and branches intersecting window, by first line and then by key.
+     * Returns the number of events looked at, the events starting in the lines of the window or up to
+     * the tallest event above them.
+     */
+    template<typename Visit_Fn>
+    constexpr size_type visit(Rect window, Visit_Fn&& visit) const
+    {
+      if(m_keys.empty())
+        return 0;
+
+      coord_type const first_line = std::max(top_line(window) - m_max_extent, m_top_line);
+      coord_type const last_line = std::min(bot_line(window), m_top_line + static_cast<coord_type>(m_line_begin.size()) - 2);
+      if(first_line > last_line)
+        return 0;
+
+      size_type const begin = m_line_begin[static_cast<size_type>(first_line - m_top_line)];
+      size_type const end = m_line_begin[static_cast<size_type>(last_line - m_top_line) + 1];
+      for(size_type i = begin; i < end; ++i) {
+        Rect const event_rect = rect(m_keys[i]);
+        if(trim::intersects(event_rect, window))
+          visit(m_keys[i], event_rect);
+      }
+      return end - begin;
+    }
+  };
+
+  /*!
+   * All the nodes and branches of a laid out tree, stored as one flat list of primitive sprites.
+   * Node labels are not copied, they must outlive the sprite.
+   */
   struct Tree_Sprite
   {
     private:
@@ -30,21 +167,126 @@ namespace trim
     {
       size_type const num_nodes = tree.size();
 
+      // roughly a box and a label per node, plus a few lines and joints per branch
       std::vector<Sprite> sprites {};
+      sprites.reserve(num_nodes * 4);
 
       // add all node sprites
+      for(size_type node = 0; node < num_nodes; ++node)
+        append_node(sprites, tree, root, node_labels, layout, node);
+
+      // add all branches
       for(size_type node = 0; node < num_nodes; ++node) {
-        Rect const rect = layout[node].rect;
-        coord_type const node_height = height(rect);
-        coord_type const node_width = width(rect);
-        bool const is_top_connected = (node != root);
-        bool const is_bot_connected = (tree.num_children(node) > 0);
-        TRIM_ASSERT(node_height > 0);
-        TRIM_ASSERT(node_width > 0);
-        Sprite sprite = Node_Sprite(node_height, node_width, is_top_connected, is_bot_connected, node_labels(node));
-        sprites.push_back(Translate_Sprite(std::move(sprite), rect.p1.line, rect.p1.column));
+        if(tree.num_children(node) > 0)
+          append_branch(sprites, tree, layout, node);
+      }
+
+      m_composite = Composite_Sprite(std::move(sprites));
+    }
+
+    /*!
+     * Builds only the nodes and branches that intersect the window.
+     * The nodes are sorted by line for this window only, see below to share the index between windows.
+     */
+    constexpr Tree_Sprite(Tree const& tree, size_type root, Labels const& node_labels, Labels const& edge_labels, Tree_Layout const& layout, Rect window)
+      : Tree_Sprite(tree, root, node_labels, edge_labels, layout, Tree_Line_Index(tree, layout), window)
+    {}
+
+    /*!
+     * Builds only the nodes and branches that intersect the window, found in an index of the same tree and layout.
+     * Only the levels the window covers are looked at, the cost is proportional to the sprites near the window.
+     */
+    constexpr Tree_Sprite(Tree const& tree, size_type root, Labels const& node_labels, [[maybe_unused]] Labels const& edge_labels, Tree_Layout const& layout, Tree_Line_Index const& index, Rect window)
+      : m_composite()
+    {
+      size_type const num_nodes = tree.size();
+
+      // nodes come before branches, both in node order, as in the sprite of the whole tree
+      std::vector<size_type> keys {};
+      index.visit(window, [&keys](size_type key, Rect) { keys.push_back(key); });
+      std::ranges::sort(keys);
+
+      std::vector<Sprite> sprites {};
+      sprites.reserve(keys.size() * 4);
+      for(size_type key : keys) {
+        if(key < num_nodes) {
+          append_node(sprites, tree, root, node_labels, layout, key);
+        } else {
+          append_branch(sprites, tree, layout, key - num_nodes);
+        }
       }
 
+      m_composite = Composite_Sprite(std::move(sprites));
+    }
+
+    [[nodiscard]] constexpr Rect rect() const noexcept
+    {
+      return m_composite.rect();
+    }
+
+    [[nodiscard]] constexpr Draw_Result draw(Style const& style, Point cursor) const noexcept
+    {
+      TRIM_ASSERT(trim::envelopes(rect(), cursor));
+      return m_composite.draw(style, cursor);
+    }
+
+    template<Is_Canvas Target>
+    constexpr void raster(Style const& style, Target& canvas, Point origin) const noexcept
+    {
+      m_composite.raster(style, canvas, origin);
+    }
+
+    [[nodiscard]] constexpr Sprite_Category category() const noexcept
+    {
+      return Sprite_Category::NODE | Sprite_Category::BRANCH | Sprite_Category::TEXT;
+    }
+
+    constexpr void append_to(std::vector<Sprite>& sprites, coord_type lines, coord_type columns) const
+    {
+      m_composite.append_to(sprites, lines, columns);
+    }
+
+    [[nodiscard]] constexpr Composite_Sprite const& composite() const& noexcept
+    {
+      return m_composite;
+    }
+
+    [[nodiscard]] constexpr Composite_Sprite composite() && noexcept
+    {
+      return std::move(m_composite);
+    }
+
+    /*!
+     * The bounding box of the branch from a node to its children.
+     * All the lines and joints of the branch lie between the parent and the children anchors.
+     */
+    [[nodiscard]] static constexpr Rect branch_rect(Tree const& tree, Tree_Layout const& layout, size_type node) noexcept
+    {
+      return detail::branch_rect(tree, layout, node);
+    }
+
+    // appends the box and the label of a node
+    static constexpr void append_node(std::vector<Sprite>& sprites, Tree const& tree, size_type root, Labels const& node_labels, Tree_Layout const& layout, size_type node)
+    {
+      Rect const rect = layout[node].rect;
+      coord_type const node_height = height(rect);
+      coord_type const node_width = width(rect);
+      bool const is_top_connected = (node != root);
+      bool const is_bot_connected = (tree.num_children(node) > 0);
+      TRIM_ASSERT(node_height > 0);
+      TRIM_ASSERT(node_width > 0);
+      Node_Sprite sprite = Node_Sprite(node_height, node_width, is_top_connected, is_bot_connected, node_labels(node));
+      size_type const first = sprites.size();
+      sprite.append_to(sprites, rect.p1.line, rect.p1.column);
+      set_owner(sprites, first, node);
+    }
+
+    // appends the lines and joints connecting a node to its children
+    static constexpr void append_branch(std::vector<Sprite>& sprites, Tree const& tree, Tree_Layout const& layout, size_type node)
+    {
+      TRIM_ASSERT(tree.num_children(node) > 0);
+      size_type const first = sprites.size();
+
       auto const add_direct_branch = [&](size_type node, size_type child) -> void {
         Rect const parent_rect = layout[node].rect;
         Rect const child_rect = layout[child].rect;
@@ -54,7 +296,7 @@ namespace trim
         TRIM_ASSERT(parent_point.column == child_point.column);
 
         Sprite line = Vertical_Line_Sprite(child_point.line - parent_point.line, true, true);
-        sprites.push_back(Translate_Sprite(std::move(line), parent_point.line, parent_point.column));
+        sprites.push_back(trim::translate(std::move(line), parent_point.line, parent_point.column));
       };
 
       auto const add_spline_branch = [&](size_type node, size_type child) -> void {
@@ -72,8 +314,8 @@ namespace trim
         Point const r1 = trim::translate(mid1, -parent_point.line, -parent_point.column);
         Point const r2 = trim::translate(mid2, -parent_point.line, -parent_point.column);
         Point const r3 = trim::translate(child_point, -parent_point.line, -parent_point.column);
-        Sprite spline = Spline3_Sprite(r1, r2, r3, true, true);
-        sprites.push_back(Translate_Sprite(std::move(spline), parent_point.line, parent_point.column));
+        Spline3_Sprite spline = Spline3_Sprite(r1, r2, r3, true, true);
+        spline.append_to(sprites, parent_point.line, parent_point.column);
       };
 
       auto const add_trunk = [&](size_type node) -> void {
@@ -96,39 +338,39 @@ namespace trim
         // draw the horizontal trunk line
         coord_type const trunk_length = trim::signed_length(Horizontal_Segment(trunk_left, trunk_right));
         Sprite trunk_hline = Horizontal_Line_Sprite(trunk_length, true, true);
-        sprites.push_back(Translate_Sprite(std::move(trunk_hline), trunk_left.line, trunk_left.column));
+        sprites.push_back(trim::translate(std::move(trunk_hline), trunk_left.line, trunk_left.column));
 
         // draw the vertical trunk line starting from parent
         coord_type const trunk_height = trim::signed_length(Vertical_Segment(parent_point, trunk_down));
         Sprite trunk_vline = Vertical_Line_Sprite(trunk_height, true, true);
-        sprites.push_back(Translate_Sprite(std::move(trunk_vline), parent_point.line, parent_point.column));
+        sprites.push_back(trim::translate(std::move(trunk_vline), parent_point.line, parent_point.column));
 
         // draw the down trunk joint
         if(trunk_down == trunk_left) {
           Sprite joint = Joint_Sprite(Multi_Joint::RIGHT_DOWN_UP);
-          sprites.push_back(Translate_Sprite(std::move(joint), trunk_down.line, trunk_down.column));
+          sprites.push_back(trim::translate(std::move(joint), trunk_down.line, trunk_down.column));
         } else if(trunk_down == trunk_right) {
           Sprite joint = Joint_Sprite(Multi_Joint::DOWN_LEFT_UP);
-          sprites.push_back(Translate_Sprite(std::move(joint), trunk_down.line, trunk_down.column));
+          sprites.push_back(trim::translate(std::move(joint), trunk_down.line, trunk_down.column));
         } else if(trunk_down.column > trunk_right.column) {
           Sprite joint = Joint_Sprite(Multi_Joint::LEFT_UP);
-          sprites.push_back(Translate_Sprite(std::move(joint), trunk_down.line, trunk_down.column));
+          sprites.push_back(trim::translate(std::move(joint), trunk_down.line, trunk_down.column));
         } else if(trunk_down.column < trunk_left.column) {
           Sprite joint = Joint_Sprite(Multi_Joint::RIGHT_UP);
-          sprites.push_back(Translate_Sprite(std::move(joint), trunk_down.line, trunk_down.column));
+          sprites.push_back(trim::translate(std::move(joint), trunk_down.line, trunk_down.column));
         } else {
           Sprite joint = Joint_Sprite(Multi_Joint::RIGHT_LEFT_UP);
-          sprites.push_back(Translate_Sprite(std::move(joint), trunk_down.line, trunk_down.column));
+          sprites.push_back(trim::translate(std::move(joint), trunk_down.line, trunk_down.column));
         }
 
         // draw the trunk left corner
         if(trunk_left != trunk_down) {
           if(trunk_left.column < trunk_down.column) {
             Sprite corner = Joint_Sprite(Multi_Joint::RIGHT_DOWN);
-            sprites.push_back(Translate_Sprite(std::move(corner), trunk_left.line, trunk_left.column));
+            sprites.push_back(trim::translate(std::move(corner), trunk_left.line, trunk_left.column));
           } else {
             Sprite corner = Joint_Sprite(Multi_Joint::RIGHT_DOWN_LEFT);
-            sprites.push_back(Translate_Sprite(std::move(corner), trunk_left.line, trunk_left.column));
+            sprites.push_back(trim::translate(std::move(corner), trunk_left.line, trunk_left.column));
           }
         }
 
@@ -136,23 +378,23 @@ namespace trim
         if(trunk_right != trunk_down) {
           if(trunk_right.column > trunk_down.column) {
             Sprite corner = Joint_Sprite(Multi_Joint::DOWN_LEFT);
-            sprites.push_back(Translate_Sprite(std::move(corner), trunk_right.line, trunk_right.column));
+            sprites.push_back(trim::translate(std::move(corner), trunk_right.line, trunk_right.column));
           } else {
             Sprite corner = Joint_Sprite(Multi_Joint::RIGHT_DOWN_LEFT);
-            sprites.push_back(Translate_Sprite(std::move(corner), trunk_right.line, trunk_right.column));
+            sprites.push_back(trim::translate(std::move(corner), trunk_right.line, trunk_right.column));
           }
         }
 
         // if trunk_down is before trunk_left, draw an additional horizontal segment
         if(trunk_down.column < trunk_left.column) {
           Sprite line = Horizontal_Line_Sprite(trunk_left.column - trunk_down.column, true, true);
-          sprites.push_back(Translate_Sprite(std::move(line), trunk_down.line, trunk_down.column));
+          sprites.push_back(trim::translate(std::move(line), trunk_down.line, trunk_down.column));
         }
 
         // if trunk_down is after trunk_right, draw an additional horizontal segment
         if(trunk_down.column > trunk_right.column) {
           Sprite line = Horizontal_Line_Sprite(trunk_right.column - trunk_down.column, true, true);
-          sprites.push_back(Translate_Sprite(std::move(line), trunk_right.line, trunk_right.column));
+          sprites.push_back(trim::translate(std::move(line), trunk_right.line, trunk_right.column));
         }
 
         // draw the inner trunk joints
@@ -164,10 +406,10 @@ namespace trim
 
           if(trunk_point == trunk_down) {
             Sprite joint = Joint_Sprite(Multi_Joint::ALL);
-            sprites.push_back(Translate_Sprite(std::move(joint), trunk_point.line, trunk_point.column));
+            sprites.push_back(trim::translate(std::move(joint), trunk_point.line, trunk_point.column));
           } else {
             Sprite joint = Joint_Sprite(Multi_Joint::RIGHT_DOWN_LEFT);
-            sprites.push_back(Translate_Sprite(std::move(joint), trunk_point.line, trunk_point.column));
+            sprites.push_back(trim::translate(std::move(joint), trunk_point.line, trunk_point.column));
           }
         }
 
@@ -180,51 +422,43 @@ namespace trim
           coord_type dist = trim::length(Vertical_Segment(trunk_point, child_point));
           if(dist > 1) {
             Sprite line = Vertical_Line_Sprite(dist, true, true);
-            sprites.push_back(Translate_Sprite(std::move(line), trunk_point.line, trunk_point.column));
+            sprites.push_back(trim::translate(std::move(line), trunk_point.line, trunk_point.column));
           }
         }
       };
 
-      // add all single branches
-      for(size_type node = 0; node < num_nodes; ++node) {
-        if(tree.num_children(node) == 1) {
-          size_type const child = tree.get_child(node, 0);
+      if(tree.num_children(node) == 1) {
+        size_type const child = tree.get_child(node, 0);
 
-          Rect const parent_rect = layout[node].rect;
-          Point const parent_point = trim::midpoint(trim::bot_segment(parent_rect));
+        Rect const parent_rect = layout[node].rect;
+        Point const parent_point = trim::midpoint(trim::bot_segment(parent_rect));
 
-          Rect const child_rect = layout[child].rect;
-          Point const child_point = trim::midpoint(trim::top_segment(child_rect));
+        Rect const child_rect = layout[child].rect;
+        Point const child_point = trim::midpoint(trim::top_segment(child_rect));
 
-          if(parent_point.column == child_point.column) {
-            add_direct_branch(node, child);
-          } else {
-            add_spline_branch(node, child);
-          }
-        } else if(tree.num_children(node) > 1) {
-          add_trunk(node);
+        if(parent_point.column == child_point.column) {
+          add_direct_branch(node, child);
+        } else {
+          add_spline_branch(node, child);
         }
+      } else {
+        add_trunk(node);
       }
 
-      m_composite = Composite_Sprite(std::move(sprites));
+      set_owner(sprites, first, node);
     }
 
-    [[nodiscard]] constexpr Rect rect() const noexcept
-    {
-      return m_composite.rect();
-    }
-
-    [[nodiscard]] constexpr Draw_Result draw(Style const& style, Point cursor) const noexcept
-    {
-      TRIM_ASSERT(trim::envelopes(rect(), cursor));
-      return m_composite.draw(style, cursor);
-    }
+    private:
 
-    [[nodiscard]] constexpr Sprite_Category category() const noexcept
+    // the sprites appended for a node take their rainbow color from it
+    static constexpr void set_owner(std::vector<Sprite>& sprites, size_type first, size_type node) noexcept
     {
-      return Sprite_Category::NODE | Sprite_Category::BRANCH | Sprite_Category::TEXT;
+      TRIM_ASSERT(node <= UINT32_MAX);
+      for(size_type i = first; i < sprites.size(); ++i)
+        sprites[i].set_owner(static_cast<std::uint32_t>(node));
     }
   };
 
-  static_assert(Is_Sprite<Tree_Sprite>);
+  static_assert(Is_Raster_Sprite<Tree_Sprite>);
+  static_assert(Is_Sprite_Group<Tree_Sprite>);
 } // namespace trim
@@ -69,6 +69,11 @@ namespace trim
     return Text_Modifier(static_cast<unsigned>(lhs) | static_cast<unsigned>(rhs));
   }
 
+  [[nodiscard]] constexpr bool operator&(Text_Modifier lhs, Text_Modifier rhs) noexcept
+  {
+    return static_cast<bool>(static_cast<unsigned>(lhs) & static_cast<unsigned>(rhs));
+  }
+
   [[nodiscard]] constexpr Multi_Joint operator|(Single_Joint lhs, Single_Joint rhs) noexcept
   {
     return Multi_Joint(static_cast<unsigned>(lhs) | static_cast<unsigned>(rhs));
@@ -266,6 +271,48 @@ namespace trim
     .tree_align = default_style.tree_align,
   };
 
+  // every glyph is a single byte, for pipelines that do not handle UTF-8
+  constexpr inline Style ascii_style = {
+    .box_vertical_line    = "|",
+    .box_horizontal_line  = "-",
+    .box_top_left_corner  = "+",
+    .box_top_right_corner = "+",
+    .box_bot_left_corner  = "+",
+    .box_bot_right_corner = "+",
+
+    .vertical_line    = "|",
+    .horizontal_line  = "-",
+
+    .top_connection       = "+",
+    .bot_connection       = "+",
+
+    .joint_down_left    = ".",
+    .joint_right_down   = ".",
+    .joint_left_up      = "'",
+    .joint_right_up     = "'",
+
+    .joint_right_down_left  = "+",
+    .joint_right_down_up    = "+",
+    .joint_right_left_up    = "+",
+    .joint_down_left_up     = "+",
+    .joint_all              = "+",
+
+    .box_color      = default_style.box_color,
+    .branch_color   = default_style.branch_color,
+    .text_color     = default_style.text_color,
+    .text_modifier  = default_style.text_modifier,
+    .text_align     = default_style.text_align,
+
+    .sibling_margin           = default_style.sibling_margin,
+    .level_margin             = default_style.level_margin,
+    .node_vertical_padding    = default_style.node_vertical_padding,
+    .node_horizontal_padding  = default_style.node_horizontal_padding,
+    .node_minimum_width       = default_style.node_minimum_width,
+    .node_minimum_height      = default_style.node_minimum_height,
+
+    .tree_align = default_style.tree_align,
+  };
+
   // clang-format on
 
 } // namespace trim
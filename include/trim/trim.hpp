@@ -1,9 +1,15 @@
 #pragma once
+#include <trim/layout/incremental_layout.hpp>
 #include <trim/layout/make_layout.hpp>
+#include <trim/layout/parallel_layout.hpp>
 #include <trim/layout/tree_layout.hpp>
 #include <trim/parsing/bitstring.hpp>
 #include <trim/parsing/markdown.hpp>
 #include <trim/parsing/parentheses.hpp>
 #include <trim/parsing/parser.hpp>
+#include <trim/render/live.hpp>
+#include <trim/scene/html.hpp>
 #include <trim/scene/scene.hpp>
+#include <trim/scene/svg.hpp>
+#include <trim/scene/tree_stream.hpp>
 #include <trim/util/assert.hpp>
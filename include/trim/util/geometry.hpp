@@ -331,6 +331,23 @@ namespace trim
     return Rect(Point(min_line, min_column), Point(max_line, max_column));
   }
 
+  [[nodiscard]] constexpr bool intersects(Rect const& lhs, Rect const& rhs) noexcept
+  {
+    bool overlap_v = trim::top_line(lhs) <= trim::bot_line(rhs) && trim::top_line(rhs) <= trim::bot_line(lhs);
+    bool overlap_h = trim::left_column(lhs) <= trim::right_column(rhs) && trim::left_column(rhs) <= trim::right_column(lhs);
+    return overlap_v && overlap_h;
+  }
+
+  [[nodiscard]] constexpr Rect intersection(Rect const& lhs, Rect const& rhs) noexcept
+  {
+    TRIM_ASSERT(trim::intersects(lhs, rhs));
+    coord_type min_line = std::max(trim::top_line(lhs), trim::top_line(rhs));
+    coord_type max_line = std::min(trim::bot_line(lhs), trim::bot_line(rhs));
+    coord_type min_column = std::max(trim::left_column(lhs), trim::left_column(rhs));
+    coord_type max_column = std::min(trim::right_column(lhs), trim::right_column(rhs));
+    return Rect(Point(min_line, min_column), Point(max_line, max_column));
+  }
+
   [[nodiscard]] constexpr bool on_horizontal_segments(Rect const& rect, Point const& point) noexcept
   {
     return trim::envelopes(trim::top_segment(rect), point) || trim::envelopes(trim::bot_segment(rect), point);
@@ -0,0 +1,191 @@
+#pragma once
+#include <trim/util/ints.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace trim
+{
+  /*!
+   * Runs fixed lists of tasks on several threads, with work stealing.
+   * Every worker starts with a contiguous share of the tasks of about the same total weight and takes
+   * them from the back of its share. A worker out of tasks steals the front half of the share of another
+   * worker, so neighbouring tasks tend to run on the same thread and tasks are only locked in small numbers.
+   * The threads are started with the pool and wait for the next run in between, so a pool can run many
+   * short lists of tasks. Tasks may not add tasks, run returns when every task has run.
+   * A pool runs a single list at a time, run can't be called from a task or from several threads at once.
+   */
+  struct Task_Pool
+  {
+    private:
+
+    // the tasks left to a worker are [begin, end)
+    struct Share
+    {
+      std::mutex mutex {};
+      size_type begin {};
+      size_type end {};
+    };
+
+    // the list of tasks being run, shared with the threads of the pool
+    struct Job
+    {
+      Share* shares {};
+      unsigned num_workers {};
+      void (*call)(void*, size_type) {};
+      void* task {};
+    };
+
+    unsigned m_num_threads = 1;
+
+    // a new job is published by bumping the generation, run waits until no thread is busy with it
+    std::mutex m_mutex {};
+    std::condition_variable_any m_job_ready {};
+    std::condition_variable m_job_done {};
+    Job m_job {};
+    std::uint64_t m_generation {};
+    unsigned m_busy_threads {};
+
+    // last, so the threads are stopped and joined before the rest of the pool is destroyed
+    std::vector<std::jthread> m_threads {};
+
+    public:
+
+    Task_Pool() = default;
+
+    explicit Task_Pool(unsigned num_threads)
+      : m_num_threads(std::max(num_threads, 1u))
+    {
+      // the calling thread of run is the first worker
+      m_threads.reserve(m_num_threads - 1);
+      for(unsigned worker = 1; worker < m_num_threads; ++worker)
+        m_threads.emplace_back([this, worker](std::stop_token stop) { wait_for_jobs(stop, worker); });
+    }
+
+    // the threads refer to the pool
+    Task_Pool(Task_Pool const&) = delete;
+    Task_Pool& operator=(Task_Pool const&) = delete;
+
+    [[nodiscard]] unsigned num_threads() const noexcept
+    {
+      return m_num_threads;
+    }
+
+    // calls task(i) for each index of weights, weights are the expected relative costs of the tasks
+    template<typename Task_Fn>
+    void run(std::span<size_type const> weights, Task_Fn task)
+    {
+      unsigned const num_workers = static_cast<unsigned>(std::clamp<size_type>(weights.size(), 1, m_num_threads));
+      std::unique_ptr<Share[]> shares = std::make_unique<Share[]>(num_workers);
+
+      // shares end where the running weight reaches the next multiple of the total weight over the workers
+      size_type total_weight = 0;
+      for(size_type weight : weights)
+        total_weight += weight;
+
+      size_type weight = 0;
+      size_type index = 0;
+      for(unsigned worker = 0; worker < num_workers; ++worker) {
+        shares[worker].begin = index;
+        while(index < weights.size() && (worker + 1 == num_workers || weight < total_weight / num_workers * (worker + 1)))
+          weight += weights[index++];
+        shares[worker].end = index;
+      }
+
+      Job const job = Job {
+        .shares = shares.get(),
+        .num_workers = num_workers,
+        .call = [](void* task, size_type index) { (*static_cast<Task_Fn*>(task))(index); },
+        .task = &task,
+      };
+
+      if(num_workers > 1) {
+        std::scoped_lock lock(m_mutex);
+        m_job = job;
+        m_generation += 1;
+        m_busy_threads = static_cast<unsigned>(m_threads.size());
+      }
+      m_job_ready.notify_all();
+
+      work(job, 0);
+
+      // the shares and the task live in this frame, the threads must be done with them
+      if(num_workers > 1) {
+        std::unique_lock lock(m_mutex);
+        m_job_done.wait(lock, [this]() { return m_busy_threads == 0; });
+      }
+    }
+
+    private:
+
+    static void work(Job const& job, unsigned worker)
+    {
+      if(worker >= job.num_workers)
+        return;
+      while(std::optional<size_type> next = take(job.shares, job.num_workers, worker))
+        job.call(job.task, next.value());
+    }
+
+    void wait_for_jobs(std::stop_token const& stop, unsigned worker)
+    {
+      std::uint64_t generation = 0;
+      while(true) {
+        Job job {};
+        {
+          std::unique_lock lock(m_mutex);
+          if(!m_job_ready.wait(lock, stop, [&]() { return m_generation != generation; }))
+            return;
+          generation = m_generation;
+          job = m_job;
+        }
+
+        work(job, worker);
+
+        std::scoped_lock lock(m_mutex);
+        if(--m_busy_threads == 0)
+          m_job_done.notify_one();
+      }
+    }
+
+    // the next task of a worker, stolen from another worker when its share is empty
+    [[nodiscard]] static std::optional<size_type> take(Share* shares, unsigned num_workers, unsigned worker)
+    {
+      Share& own = shares[worker];
+      {
+        std::scoped_lock lock(own.mutex);
+        if(own.begin < own.end)
+          return --own.end;
+      }
+
+      for(unsigned i = 1; i < num_workers; ++i) {
+        Share& victim = shares[(worker + i) % num_workers];
+        size_type begin = 0;
+        size_type end = 0;
+        {
+          std::scoped_lock lock(victim.mutex);
+          size_type const count = (victim.end - victim.begin + 1) / 2;
+          begin = victim.begin;
+          end = victim.begin + count;
+          victim.begin = end;
+        }
+        if(begin == end)
+          continue;
+
+        // the last stolen task runs now, the others are left to be stolen in turn
+        std::scoped_lock lock(own.mutex);
+        own.begin = begin;
+        own.end = end - 1;
+        return end - 1;
+      }
+      return std::nullopt;
+    }
+  };
+} // namespace trim
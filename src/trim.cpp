@@ -1,16 +1,27 @@
 #include <trim/cli/cli.hpp>
 #include <trim/color/rgb.hpp>
 #include <trim/layout/make_layout.hpp>
+#include <trim/layout/parallel_layout.hpp>
 #include <trim/layout/tree_layout.hpp>
 #include <trim/parsing/bitstring.hpp>
 #include <trim/parsing/markdown.hpp>
 #include <trim/parsing/parentheses.hpp>
+#include <trim/port/terminal.hpp>
+#include <trim/render/live.hpp>
+#include <trim/render/sink.hpp>
+#include <trim/scene/html.hpp>
+#include <trim/scene/parallel.hpp>
 #include <trim/scene/scene.hpp>
+#include <trim/scene/svg.hpp>
+#include <trim/scene/tree_stream.hpp>
 #include <trim/style/style.hpp>
 
+#include <chrono>
 #include <fstream>
 #include <iostream>
+#include <optional>
 #include <string>
+#include <thread>
 
 template<typename Stream>
 [[nodiscard]] constexpr std::string read_input(Stream& stream)
@@ -24,6 +35,112 @@ template<typename Stream>
   return result;
 }
 
+// the parsers own the labels of their results, they must outlive them
+struct Parsers
+{
+  trim::Bitstring_Parser bitstring {};
+  trim::Markdown_Parser markdown {};
+  trim::Parentheses_Parser parentheses {};
+};
+
+// parses the input with a parser chosen by heuristics, errors are printed
+[[nodiscard]] std::optional<trim::Parse_Result> parse_input(Parsers& parsers, std::string const& input_text)
+{
+  trim::Parse_Result parsed {};
+
+  // choose the parser to use based on heuristics
+  if(std::ranges::count(input_text, '#') > 0) {
+    // use the markdown parser
+    parsed = parsers.markdown.parse(input_text);
+  } else if(!input_text.empty() && (input_text[0] == '0' || input_text[0] == '1')) {
+    // use the bitstring parser
+    parsed = parsers.bitstring.parse(input_text);
+  } else if(!input_text.empty() && (input_text[0] == '(')) {
+    // use the parentheses parser
+    parsed = parsers.parentheses.parse(input_text);
+  } else {
+    std::cerr << "Can't parse the given input.\n";
+    std::cerr << "Allowed inputs are markdown, balanced parentheses, or a string of binary digits.\n";
+    return std::nullopt;
+  }
+
+  // print parser errors
+  // TODO: report error line numbers
+  if(!parsed.errors.empty()) {
+    for(auto& error : parsed.errors) {
+      std::cerr << error.message << " (pos: " << error.position << ")" << std::endl;
+    }
+    return std::nullopt;
+  }
+
+  return parsed;
+}
+
+// the part of the scene to draw, std::nullopt if the viewport is outside the scene
+[[nodiscard]] std::optional<trim::Rect> draw_window(trim::cli::Options const& cli, trim::Rect scene_rect)
+{
+  if(!cli.viewport)
+    return scene_rect;
+
+  trim::Rect const viewport = trim::translate(cli.viewport.value(), scene_rect.p1.line, scene_rect.p1.column);
+  if(!trim::intersects(viewport, scene_rect))
+    return std::nullopt;
+  return trim::intersection(viewport, scene_rect);
+}
+
+// number of threads laying out and drawing the tree
+[[nodiscard]] unsigned thread_count(trim::cli::Options const& cli)
+{
+  unsigned const num_threads = static_cast<unsigned>(cli.num_threads.value_or(1));
+  return num_threads == 0 ? std::thread::hardware_concurrency() : num_threads;
+}
+
+// the contour engine places subtrees on several threads when asked to, with the same result
+[[nodiscard]] trim::Tree_Layout lay_out(trim::cli::Options const& cli, trim::Parse_Result const& parsed, trim::Style const& style)
+{
+  trim::Layout_Engine const engine = cli.layout_engine.value_or(trim::Layout_Engine::CONTOUR);
+  if(engine == trim::Layout_Engine::CONTOUR && thread_count(cli) > 1)
+    return trim::make_parallel_layout(parsed.tree, parsed.root, parsed.node_labels, parsed.edge_labels, style, thread_count(cli));
+  return trim::make_layout(parsed.tree, parsed.root, parsed.node_labels, parsed.edge_labels, style, engine);
+}
+
+/*!
+ * Redraws the tree of a file every few seconds until interrupted, only the changed cells are written.
+ * A frame that can't be read or parsed is skipped, the last good frame stays on the screen.
+ */
+int run_live(trim::cli::Options const& cli, trim::Style const& style, std::string const& file_name)
+{
+  trim::Ansi_Options options {};
+  if(cli.color_depth)
+    options.color_depth = cli.color_depth.value().value_or(trim::port::detect_color_depth(1));
+
+  trim::Live_Screen screen = trim::Live_Screen(options);
+  trim::Fd_Sink sink = trim::Fd_Sink(1);
+
+  while(sink.ok()) {
+    std::ifstream input_file = std::ifstream(file_name);
+    if(input_file.is_open()) {
+      Parsers parsers {};
+      std::optional<trim::Parse_Result> parsed = parse_input(parsers, read_input(input_file));
+
+      if(parsed) {
+        trim::Tree_Layout layout = lay_out(cli, parsed.value(), style);
+        trim::Scene scene = trim::Scene(trim::Tree_Sprite(parsed->tree, parsed->root, parsed->node_labels, parsed->edge_labels, layout));
+
+        if(std::optional<trim::Rect> window = draw_window(cli, layout.rect()); window) {
+          scene.raster(style, screen.next_frame(window.value()));
+          screen.present(sink);
+        }
+      }
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(cli.live_interval.value()));
+  }
+
+  std::cerr << "Could not write the output." << std::endl;
+  return 1;
+}
+
 int main(int argc, char** argv)
 {
   using arg_span = std::span<char const* const>;
@@ -72,35 +189,12 @@ int main(int argc, char** argv)
   }
 
   // parse the input
-  trim::Bitstring_Parser bitstring_parser {};
-  trim::Markdown_Parser markdown_parser {};
-  trim::Parentheses_Parser parentheses_parser {};
-  trim::Parse_Result parsed {};
-
-  // choose the parser to use based on heuristics
-  if(std::ranges::count(input_text, '#') > 0) {
-    // use the markdown parser
-    parsed = markdown_parser.parse(input_text);
-  } else if(!input_text.empty() && (input_text[0] == '0' || input_text[0] == '1')) {
-    // use the bitstring parser
-    parsed = bitstring_parser.parse(input_text);
-  } else if(!input_text.empty() && (input_text[0] == '(')) {
-    // use the parentheses parser
-    parsed = parentheses_parser.parse(input_text);
-  } else {
-    std::cerr << "Can't parse the given input.\n";
-    std::cerr << "Allowed inputs are markdown, balanced parentheses, or a string of binary digits.\n";
+  Parsers parsers {};
+  std::optional<trim::Parse_Result> maybe_parsed = parse_input(parsers, input_text);
+  if(!maybe_parsed)
     return 1;
-  }
 
-  // print parser errors
-  // TODO: report error line numbers
-  if(!parsed.errors.empty()) {
-    for(auto& error : parsed.errors) {
-      std::cerr << error.message << " (pos: " << error.position << ")" << std::endl;
-    }
-    return 1;
-  }
+  trim::Parse_Result& parsed = maybe_parsed.value();
 
   // configure the global style
   // TODO: allow different style for each node
@@ -135,10 +229,80 @@ int main(int argc, char** argv)
   if(cli.branch_color)
     style.branch_color = cli.branch_color.value();
 
-  trim::Tree_Layout layout = trim::make_layout(parsed.tree, parsed.root, parsed.node_labels, parsed.edge_labels, style);
-  trim::Tree_Sprite sprite = trim::Tree_Sprite(parsed.tree, parsed.root, parsed.node_labels, parsed.edge_labels, layout);
-  trim::Scene scene = trim::Scene(std::move(sprite));
-  scene.draw(std::cout, style);
+  // the input file is read again for every frame
+  if(cli.live_interval) {
+    if(!cli.input_file_name) {
+      std::cerr << "--live needs an input file." << std::endl;
+      return 1;
+    }
+    return run_live(cli, style, std::string(cli.input_file_name.value()));
+  }
+
+  trim::Tree_Layout layout = lay_out(cli, parsed, style);
+
+  // the part of the scene to draw, sprites are only built for the nodes and branches inside it
+  std::optional<trim::Rect> const window = draw_window(cli, layout.rect());
+
+  trim::Tree_Stream stream = trim::Tree_Stream(parsed.tree, parsed.root, parsed.node_labels, layout);
+
+  trim::Html_Options html_options {};
+  html_options.trim_trailing_blanks = cli.trim_trailing_blanks;
+
+  trim::Ansi_Options ansi_options {};
+  ansi_options.trim_trailing_blanks = cli.trim_trailing_blanks;
+
+  // 24-bit colors unless another depth is requested
+  if(cli.color_depth)
+    ansi_options.color_depth = cli.color_depth.value().value_or(trim::port::detect_color_depth(1));
+
+  // skipped cells are not cleared, redirected output keeps plain blanks
+  if(cli.cursor_skip && trim::port::is_terminal(1))
+    ansi_options.cursor_forward_min_blanks = cli.cursor_skip.value();
+
+  // the exact size of the output, text rows are measured without being encoded
+  if(cli.measure) {
+    trim::Count_Sink count {};
+    trim::size_type size = 0;
+    if(cli.format == trim::cli::Output_Format::SVG) {
+      trim::write_svg(count, parsed.tree, parsed.root, parsed.node_labels, layout, style);
+      size = count.size();
+    } else if(window && cli.format == trim::cli::Output_Format::HTML) {
+      trim::write_html(count, stream, style, window.value(), html_options);
+      size = count.size();
+    } else if(window) {
+      size = stream.output_size(style, window.value(), ansi_options);
+    }
+
+    std::cout << size << std::endl;
+    return 0;
+  }
+
+  // rows are collected in a large buffer and written to stdout with few system calls
+  trim::Buffered_Sink<trim::Fd_Sink> sink = trim::Buffered_Sink<trim::Fd_Sink>(trim::Fd_Sink(1));
+
+  // vector output is written from the layout, the whole tree at any size
+  if(cli.format == trim::cli::Output_Format::SVG) {
+    trim::write_svg(sink, parsed.tree, parsed.root, parsed.node_labels, layout, style);
+  } else if(window && cli.format == trim::cli::Output_Format::HTML) {
+    // the rows of the text output, in a page with the colors in a stylesheet
+    trim::write_html(sink, stream, style, window.value(), html_options);
+  } else if(window) {
+    // rows are written as soon as they are complete, only the sprites crossing the current row are kept
+    unsigned const num_threads = thread_count(cli);
+
+    if(num_threads > 1) {
+      trim::draw_parallel(stream, sink, style, window.value(), num_threads, ansi_options);
+    } else {
+      stream.draw(sink, style, window.value(), ansi_options);
+    }
+  }
+
+  sink.flush();
+
+  if(!sink.sink().ok()) {
+    std::cerr << "Could not write the output." << std::endl;
+    return 1;
+  }
 
   return 0;
 }
@@ -0,0 +1,82 @@
+#pragma once
+#include <trim/trim.hpp>
+#include <trim/util/memory_ostream.hpp>
+
+namespace trim::detail::test
+{
+
+  static consteval auto compute_ansi_result(std::string_view input, Ansi_Options options) noexcept
+  {
+    auto parser = trim::Parentheses_Parser {};
+    auto parsed = parser.parse(input);
+    TRIM_ASSERT(parsed.errors.empty());
+    auto layout = make_layout(parsed.tree, parsed.root, parsed.node_labels, parsed.edge_labels, default_style);
+    auto tree = Tree_Sprite(parsed.tree, parsed.root, parsed.node_labels, parsed.edge_labels, layout);
+    auto scene = Scene(std::move(tree));
+
+    std::array<char, 4096> buffer {};
+    Memory_OStream ostream = Memory_OStream(buffer);
+    scene.draw(ostream, default_style, scene.rect(), options);
+    return buffer;
+  }
+
+  // trailing blanks are dropped, interior runs of 2 or more blanks become cursor forward sequences
+  template<std::array data = compute_ansi_result("(()())", Ansi_Options {.trim_trailing_blanks = true, .cursor_forward_min_blanks = 2})>
+  static constexpr bool test_cursor_forward() noexcept
+  {
+    using namespace std::string_view_literals;
+    constexpr std::string_view view = std::string_view(data.data());
+    constexpr std::string_view expected =
+      "\033[3C┌───┐\n"
+      "\033[3C| 0 |\n"
+      "\033[3C└─┬─┘\n"
+      "\033[2C┌──┴───┐\n"
+      "┌─┴─┐\033[2C┌─┴─┐\n"
+      "| 1 |\033[2C| 2 |\n"
+      "└───┘\033[2C└───┘\n"sv;
+
+    static_assert(view == expected);
+    return true;
+  }
+
+  static_assert(test_cursor_forward());
+
+  static consteval auto compute_ascii_result(std::string_view input) noexcept
+  {
+    Style style = ascii_style;
+    style.box_color = Color_RGB::RED;
+
+    auto parser = trim::Parentheses_Parser {};
+    auto parsed = parser.parse(input);
+    TRIM_ASSERT(parsed.errors.empty());
+    auto layout = make_layout(parsed.tree, parsed.root, parsed.node_labels, parsed.edge_labels, style);
+    auto stream = Tree_Stream(parsed.tree, parsed.root, parsed.node_labels, layout);
+
+    std::array<char, 4096> buffer {};
+    Memory_OStream ostream = Memory_OStream(buffer);
+    stream.draw(ostream, style, stream.rect(), Ansi_Options {.trim_trailing_blanks = true, .cursor_forward_min_blanks = 2});
+    return buffer;
+  }
+
+  // rows of single byte glyphs are copied as bytes, with the same colors and blanks as other rows
+  template<std::array data = compute_ascii_result("(()())")>
+  static constexpr bool test_ascii_rows() noexcept
+  {
+    using namespace std::string_view_literals;
+    constexpr std::string_view view = std::string_view(data.data());
+    constexpr std::string_view expected =
+      "\033[3C\033[38;2;255;0;0m+---+\033[0m\n"
+      "\033[3C\033[38;2;255;0;0m| \033[0m0 \033[38;2;255;0;0m|\033[0m\n"
+      "\033[3C\033[38;2;255;0;0m+-+-+\033[0m\n"
+      "\033[2C.--+---.\n"
+      "\033[38;2;255;0;0m+-+-+\033[2C+-+-+\033[0m\n"
+      "\033[38;2;255;0;0m| \033[0m1 \033[38;2;255;0;0m|\033[2C| \033[0m2 \033[38;2;255;0;0m|\033[0m\n"
+      "\033[38;2;255;0;0m+---+\033[2C+---+\033[0m\n"sv;
+
+    static_assert(view == expected);
+    return true;
+  }
+
+  static_assert(test_ascii_rows());
+
+} // namespace trim::detail::test
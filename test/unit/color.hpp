@@ -0,0 +1,99 @@
+#pragma once
+#include <trim/trim.hpp>
+#include <trim/util/memory_ostream.hpp>
+
+namespace trim::detail::test
+{
+
+  static consteval auto compute_colored_result(std::string_view input) noexcept
+  {
+    Style style = default_style;
+    style.box_color = Color_RGB::RED;
+    style.branch_color = Color_RGB::BLUE;
+
+    auto parser = trim::Parentheses_Parser {};
+    auto parsed = parser.parse(input);
+    TRIM_ASSERT(parsed.errors.empty());
+    auto layout = make_layout(parsed.tree, parsed.root, parsed.node_labels, parsed.edge_labels, style);
+    auto tree = Tree_Sprite(parsed.tree, parsed.root, parsed.node_labels, parsed.edge_labels, layout);
+    auto scene = Scene(std::move(tree));
+
+    std::array<char, 4096> buffer {};
+    Memory_OStream ostream = Memory_OStream(buffer);
+    scene.draw(ostream, style);
+    return buffer;
+  }
+
+  // escape sequences are only written when the color of a visible glyph changes
+  template<std::array data = compute_colored_result("(()())")>
+  static constexpr bool test_color_runs() noexcept
+  {
+    using namespace std::string_view_literals;
+    constexpr std::string_view view = std::string_view(data.data());
+    constexpr std::string_view expected =
+      "   \033[38;2;255;0;0m┌───┐    \033[0m\n"
+      "   \033[38;2;255;0;0m| \033[0m0 \033[38;2;255;0;0m|    \033[0m\n"
+      "   \033[38;2;255;0;0m└─┬─┘    \033[0m\n"
+      "  \033[38;2;0;0;255m┌──┴───┐  \033[0m\n"
+      "\033[38;2;255;0;0m┌─┴─┐  ┌─┴─┐\033[0m\n"
+      "\033[38;2;255;0;0m| \033[0m1 \033[38;2;255;0;0m|  | \033[0m2 \033[38;2;255;0;0m|\033[0m\n"
+      "\033[38;2;255;0;0m└───┘  └───┘\033[0m\n"sv;
+
+    static_assert(view == expected);
+    return true;
+  }
+
+  static_assert(test_color_runs());
+
+  // colors are mapped to the closest color available at the requested depth
+  static consteval bool test_color_depth() noexcept
+  {
+    static_assert(nearest_ansi_256(Color_RGB(255, 165, 0)) == 214);
+    static_assert(nearest_ansi_256(Color_RGB(127, 127, 127)) == 244);
+    static_assert(nearest_ansi_256(Color_RGB(0, 0, 255)) == 21);
+    static_assert(nearest_ansi_16(Color_RGB(255, 165, 0)) == 3);
+    static_assert(nearest_ansi_16(Color_RGB(250, 0, 0)) == 9);
+
+    auto const format = [](Color_RGB color, Color_Depth depth) {
+      std::array<char, ansi_foreground_max_size> buffer {};
+      char* end = format_ansi_foreground(buffer.data(), color, depth);
+      return std::string(buffer.data(), end);
+    };
+
+    TRIM_ASSERT(format(Color_RGB(255, 165, 0), Color_Depth::ANSI_256) == "\033[38;5;214m");
+    TRIM_ASSERT(format(Color_RGB(250, 0, 0), Color_Depth::ANSI_16) == "\033[91m");
+    TRIM_ASSERT(format(Color_RGB::NONE, Color_Depth::ANSI_16) == "\033[0m");
+    TRIM_ASSERT(format(Color_RGB(250, 0, 0), Color_Depth::NONE) == "");
+    return true;
+  }
+
+  static_assert(test_color_depth());
+
+  // rainbow styles paint each node and each branch in a single color, taken from its node
+  static consteval bool test_rainbow() noexcept
+  {
+    Style style = default_style;
+    style.box_color = Color_RGB::RAINBOW;
+    style.branch_color = Color_RGB::RAINBOW;
+
+    auto parser = trim::Parentheses_Parser {};
+    auto parsed = parser.parse("(()())");
+    TRIM_ASSERT(parsed.errors.empty());
+    auto layout = make_layout(parsed.tree, parsed.root, parsed.node_labels, parsed.edge_labels, style);
+    auto scene = Scene(Tree_Sprite(parsed.tree, parsed.root, parsed.node_labels, parsed.edge_labels, layout));
+    Canvas const canvas = scene.raster(style);
+
+    // the top left and bottom right corners of the left child, and the trunk of the root
+    Point const corner = scene.rect().p1;
+    Color_RGB const top_left = canvas[trim::translate(corner, 4, 0)].color;
+    Color_RGB const bot_right = canvas[trim::translate(corner, 6, 4)].color;
+    Color_RGB const trunk = canvas[trim::translate(corner, 3, 2)].color;
+    TRIM_ASSERT(top_left == bot_right);
+    TRIM_ASSERT(top_left != trunk);
+    TRIM_ASSERT(scene.draw(style, trim::translate(corner, 5, 0)).color == top_left);
+    return true;
+  }
+
+  static_assert(test_rainbow());
+
+} // namespace trim::detail::test
@@ -1,3 +1,13 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <doctest/doctest.hpp>
 #include <unit/parens.hpp>
+#include <unit/color.hpp>
+#include <unit/viewport.hpp>
+#include <unit/stream.hpp>
+#include <unit/ansi.hpp>
+#include <unit/svg.hpp>
+#include <unit/html.hpp>
+#include <unit/live.hpp>
+#include <unit/layout.hpp>
+#include <unit/repeat.hpp>
+#include <unit/task_pool.hpp>
@@ -0,0 +1,61 @@
+#pragma once
+#include <trim/trim.hpp>
+#include <trim/util/memory_ostream.hpp>
+
+namespace trim::detail::test
+{
+
+  static consteval auto compute_html_result(std::string_view input) noexcept
+  {
+    Style style = default_style;
+    style.box_color = Color_RGB::RED;
+
+    auto parser = trim::Parentheses_Parser {};
+    auto parsed = parser.parse(input);
+    TRIM_ASSERT(parsed.errors.empty());
+    auto layout = make_layout(parsed.tree, parsed.root, parsed.node_labels, parsed.edge_labels, style);
+    auto stream = Tree_Stream(parsed.tree, parsed.root, parsed.node_labels, layout);
+
+    std::array<char, 4096> buffer {};
+    Memory_OStream ostream = Memory_OStream(buffer);
+    write_html(ostream, stream, style, stream.rect(), Html_Options {.trim_trailing_blanks = true});
+    return buffer;
+  }
+
+  // each color run is a single span of a class defined in the stylesheet, labels are escaped
+  template<std::array data = compute_html_result("((<)(&))")>
+  static constexpr bool test_html() noexcept
+  {
+    using namespace std::string_view_literals;
+    constexpr std::string_view view = std::string_view(data.data());
+    constexpr std::string_view expected = R"EOF(
+<!DOCTYPE html>
+<html>
+<head>
+<meta charset="utf-8">
+<style>
+.trim { line-height: 1.2; }
+.trim-box { color: #ff0000; }
+</style>
+</head>
+<body>
+<pre class="trim">
+   <span class="trim-box">┌───┐</span>
+   <span class="trim-box">| </span>0 <span class="trim-box">|</span>
+   <span class="trim-box">└─┬─┘</span>
+  ┌──┴───┐
+<span class="trim-box">┌─┴─┐  ┌─┴─┐</span>
+<span class="trim-box">| </span>&lt; <span class="trim-box">|  | </span>&amp; <span class="trim-box">|</span>
+<span class="trim-box">└───┘  └───┘</span>
+</pre>
+</body>
+</html>
+)EOF"sv.substr(1);
+
+    static_assert(view == expected);
+    return true;
+  }
+
+  static_assert(test_html());
+
+} // namespace trim::detail::test
@@ -0,0 +1,197 @@
+#pragma once
+#include <trim/trim.hpp>
+#include <trim/util/memory_ostream.hpp>
+
+#include <doctest/doctest.hpp>
+
+#include <random>
+#include <string>
+
+namespace trim::detail::test
+{
+
+  static consteval auto compute_walker_result(std::string_view input) noexcept
+  {
+    auto parser = trim::Parentheses_Parser {};
+    auto parsed = parser.parse(input);
+    TRIM_ASSERT(parsed.errors.empty());
+    auto layout = make_layout(parsed.tree, parsed.root, parsed.node_labels, parsed.edge_labels, default_style, Layout_Engine::WALKER);
+    auto scene = Scene(Tree_Sprite(parsed.tree, parsed.root, parsed.node_labels, parsed.edge_labels, layout));
+
+    std::array<char, 4096> buffer {};
+    Memory_OStream ostream = Memory_OStream(buffer);
+    scene.draw(ostream, default_style);
+    return buffer;
+  }
+
+  // siblings keep the full sibling margin, parents are centered on their first and last child
+  template<std::array data = compute_walker_result("((()())(()()()))")>
+  static constexpr bool test_walker() noexcept
+  {
+    using namespace std::string_view_literals;
+    constexpr std::string_view view = std::string_view(data.data());
+    constexpr std::string_view expected = R"EOF(
+            ┌───┐                
+            | 0 |                
+            └─┬─┘                
+     ┌────────┴────────┐         
+   ┌─┴─┐             ┌─┴─┐       
+   | 1 |             | 4 |       
+   └─┬─┘             └─┬─┘       
+  ┌──┴───┐      ┌──────┼──────┐  
+┌─┴─┐  ┌─┴─┐  ┌─┴─┐  ┌─┴─┐  ┌─┴─┐
+| 2 |  | 3 |  | 5 |  | 6 |  | 7 |
+└───┘  └───┘  └───┘  └───┘  └───┘
+)EOF"sv.substr(1);
+
+    static_assert(view == expected);
+    return true;
+  }
+
+  static_assert(test_walker());
+
+  // edits placed on the path to the root give the layout of the edited tree
+  static consteval bool test_incremental() noexcept
+  {
+    auto parser = trim::Parentheses_Parser {};
+    auto parsed = parser.parse("((()())(()()()))");
+    TRIM_ASSERT(parsed.errors.empty());
+
+    Incremental_Layout layout = Incremental_Layout(parsed.tree, parsed.root, parsed.node_labels, default_style);
+    size_type const added = layout.add_node(2, String("added"));
+    layout.set_label(6, String("a wider label"));
+    layout.remove_subtree(5);
+    layout.add_node(added, String("x"));
+
+    Tree_Layout const expected = make_layout(layout.tree(), layout.root(), layout.labels(), layout.labels(), default_style);
+    for(size_type node = 0; node < expected.size(); ++node) {
+      if(layout.layout()[node].rect != expected[node].rect)
+        return false;
+    }
+    return true;
+  }
+
+  static_assert(test_incremental());
+
+  // repeated subtrees are placed once, with the offsets of the placement of every node
+  static consteval bool test_subtree_shapes() noexcept
+  {
+    auto parser = trim::Parentheses_Parser {};
+    auto parsed = parser.parse("((()())(()())(()()))");
+    TRIM_ASSERT(parsed.errors.empty());
+
+    Layout_Metrics const metrics = compute_layout_metrics(parsed.tree, parsed.root, parsed.node_labels, default_style);
+    std::optional<Subtree_Shapes> const shapes = classify_subtrees(parsed.tree, metrics.order, metrics.widths);
+    if(!shapes.has_value() || shapes->size() != 3)
+      return false;
+
+    detail::Contour_Placer placer = detail::Contour_Placer(parsed.tree, metrics.widths, default_style);
+    tree_visit_postorder(parsed.tree, parsed.root, [&](size_type node) { placer.place(node); });
+    Tree_Layout const expected = detail::layout_from_offsets(parsed.tree, parsed.root, metrics, placer.offsets());
+    Tree_Layout const layout = make_layout(parsed.tree, parsed.root, parsed.node_labels, parsed.edge_labels, default_style);
+    for(size_type node = 0; node < expected.size(); ++node) {
+      if(layout[node].rect != expected[node].rect)
+        return false;
+    }
+    return true;
+  }
+
+  static_assert(test_subtree_shapes());
+
+  // random edits of a random tree, with labels of one to three lines, give the layout of the edited tree every time
+  TEST_CASE("Incremental_Layout matches make_layout after random edits")
+  {
+    std::mt19937 rng = std::mt19937(5);
+    auto const random_label = [&rng]() -> String {
+      std::string label = std::string(1 + rng() % 9, 'a');
+      for(unsigned lines = rng() % 3; lines > 0; --lines)
+        label += "\nbb";
+      return String(label);
+    };
+
+    size_type const num_nodes = 300;
+    Tree tree = Tree(num_nodes);
+    Labels labels = Labels(num_nodes);
+    for(size_type node = 0; node < num_nodes; ++node)
+      labels[node] = random_label();
+    for(size_type node = 1; node < num_nodes; ++node)
+      tree.add_child(node - 1 - rng() % std::min<size_type>(node, 5), node);
+
+    for(Tree_Alignment align : {Tree_Alignment::NONE, Tree_Alignment::LEFT, Tree_Alignment::CENTER, Tree_Alignment::RIGHT}) {
+      Style style = default_style;
+      style.tree_align = align;
+      Incremental_Layout layout = Incremental_Layout(tree, 0, labels, style);
+
+      for(int edit = 0; edit < 200; ++edit) {
+        // an edited node is in the tree, removed nodes have an empty rect
+        size_type node = 0;
+        do {
+          node = rng() % layout.tree().size();
+        } while(node != layout.root() && layout.layout()[node].rect == Rect());
+
+        unsigned const kind = rng() % 3;
+        if(kind == 0) {
+          layout.add_node(node, random_label());
+        } else if(kind == 1) {
+          layout.set_label(node, random_label());
+        } else if(node != layout.root()) {
+          layout.remove_subtree(node);
+        }
+
+        CAPTURE(static_cast<int>(align));
+        CAPTURE(edit);
+        CAPTURE(kind);
+        Tree_Layout const expected = make_layout(layout.tree(), layout.root(), layout.labels(), layout.labels(), style);
+        REQUIRE(layout.layout().size() == expected.size());
+        size_type moved_nodes = 0;
+        for(size_type i = 0; i < expected.size(); ++i)
+          moved_nodes += (layout.layout()[i].rect != expected[i].rect);
+        REQUIRE(moved_nodes == 0);
+      }
+    }
+  }
+
+  // a random tree large enough to be split in tasks, with labels of different widths
+  // most nodes hang below one of the reach nodes before them, so a short reach gives few repeated subtrees
+  static std::pair<Tree, Labels> make_random_tree(size_type num_nodes, unsigned seed, size_type reach)
+  {
+    std::mt19937 rng = std::mt19937(seed);
+    Tree tree = Tree(num_nodes);
+    Labels labels = Labels(num_nodes);
+    for(size_type node = 0; node < num_nodes; ++node)
+      labels[node] = String(std::string(1 + rng() % 9, 'a'));
+    for(size_type node = 1; node < num_nodes; ++node)
+      tree.add_child(rng() % 4 == 0 ? rng() % node : node - 1 - rng() % std::min(node, reach), node);
+    return {std::move(tree), std::move(labels)};
+  }
+
+  TEST_CASE("make_parallel_layout matches make_layout")
+  {
+    for(size_type reach : {20000, 50}) {
+      auto const [tree, labels] = make_random_tree(20000, 42, reach);
+      CAPTURE(reach);
+
+      // the subtrees of a uniform tree repeat and are placed once per shape, the others are merged on several threads
+      Layout_Metrics const metrics = compute_layout_metrics(tree, 0, labels, default_style);
+      CHECK(classify_subtrees(tree, metrics.order, metrics.widths, detail::min_nodes_per_shape).has_value() == (reach == 20000));
+
+      for(Tree_Alignment align : {Tree_Alignment::NONE, Tree_Alignment::LEFT, Tree_Alignment::CENTER, Tree_Alignment::RIGHT}) {
+        Style style = default_style;
+        style.tree_align = align;
+        Tree_Layout const expected = make_layout(tree, 0, labels, labels, style);
+
+        for(unsigned num_threads : {2u, 3u, 8u}) {
+          CAPTURE(static_cast<int>(align));
+          CAPTURE(num_threads);
+          Tree_Layout const layout = make_parallel_layout(tree, 0, labels, labels, style, num_threads);
+          REQUIRE(layout.size() == expected.size());
+          size_type moved_nodes = 0;
+          for(size_type node = 0; node < expected.size(); ++node)
+            moved_nodes += (layout[node].rect != expected[node].rect);
+          CHECK(moved_nodes == 0);
+        }
+      }
+    }
+  }
+
+} // namespace trim::detail::test
@@ -0,0 +1,102 @@
+#pragma once
+#include <trim/trim.hpp>
+
+namespace trim::detail::test
+{
+
+  // the first frame is written in full, later frames only write the cells that changed
+  static consteval bool test_live(std::string_view input) noexcept
+  {
+    auto parser = trim::Parentheses_Parser {};
+    auto parsed = parser.parse(input);
+    auto layout = make_layout(parsed.tree, parsed.root, parsed.node_labels, parsed.edge_labels, default_style);
+    auto scene = Scene(Tree_Sprite(parsed.tree, parsed.root, parsed.node_labels, parsed.edge_labels, layout));
+    Rect const rect = scene.rect();
+
+    Live_Screen screen {};
+    std::string first {};
+    scene.raster(default_style, screen.next_frame(rect));
+    screen.append_update(first);
+
+    std::string unchanged {};
+    scene.raster(default_style, screen.next_frame(rect));
+    screen.append_update(unchanged);
+
+    std::string changed {};
+    Canvas& canvas = screen.next_frame(rect);
+    scene.raster(default_style, canvas);
+    canvas.paint(Point(top_line(rect) + 1, left_column(rect) + 2), Draw_Result("x", Color_RGB::NONE));
+    screen.append_update(changed);
+
+    return first.starts_with("\033[?2026h\033[H\033[2J") && unchanged.empty() && changed == "\033[?2026h\033[2;3Hx\033[8;1H\033[?2026l";
+  }
+
+  static_assert(test_live("(()())"));
+
+  // stamps kept across frames are rendered again when the style is changed in place
+  static consteval bool test_live_style(std::string_view input) noexcept
+  {
+    auto parser = trim::Parentheses_Parser {};
+    auto parsed = parser.parse(input);
+    auto layout = make_layout(parsed.tree, parsed.root, parsed.node_labels, parsed.edge_labels, default_style);
+    auto scene = Scene(Tree_Sprite(parsed.tree, parsed.root, parsed.node_labels, parsed.edge_labels, layout));
+    Rect const rect = scene.rect();
+
+    Style style = default_style;
+    Live_Screen screen {};
+    std::string first {};
+    scene.raster(style, screen.next_frame(rect));
+    screen.append_update(first);
+
+    style.box_top_left_corner = "+";
+    std::string changed {};
+    scene.raster(style, screen.next_frame(rect));
+    screen.append_update(changed);
+
+    return changed.find('+') != std::string::npos && changed.find("┌") == std::string::npos;
+  }
+
+  static_assert(test_live_style("(()())"));
+
+  // a glyph painted from memory reused for another glyph is interned by its bytes
+  static consteval bool test_live_glyphs() noexcept
+  {
+    Rect const rect = Rect(Point(0, 0), Point(0, 3));
+    std::string glyph = "é";
+
+    Live_Screen screen {};
+    std::string first {};
+    screen.next_frame(rect).paint(Point(0, 1), Draw_Result(glyph, Color_RGB::NONE));
+    screen.append_update(first);
+
+    glyph = "ü";
+    std::string changed {};
+    screen.next_frame(rect).paint(Point(0, 1), Draw_Result(glyph, Color_RGB::NONE));
+    screen.append_update(changed);
+
+    return first.find("é") != std::string::npos && changed.find("ü") != std::string::npos;
+  }
+
+  static_assert(test_live_glyphs());
+
+  // many multi-byte glyphs get distinct ids that give back their bytes
+  static consteval bool test_glyph_table() noexcept
+  {
+    Glyph_Table table {};
+    std::vector<std::string> glyphs {};
+    for(int i = 0; i < 300; ++i)
+      glyphs.push_back(std::string {static_cast<char>(0xC4 + i / 64), static_cast<char>(0x80 + i % 64)});
+
+    std::vector<Glyph_Table::id_type> ids {};
+    for(std::string const& glyph : glyphs)
+      ids.push_back(table.intern(glyph));
+
+    bool result = true;
+    for(std::size_t i = 0; i < glyphs.size(); ++i)
+      result = result && table.intern(glyphs[i]) == ids[i] && table.bytes(ids[i]) == glyphs[i] && ids[i] == Glyph_Table::first_interned_id + i;
+    return result;
+  }
+
+  static_assert(test_glyph_table());
+
+} // namespace trim::detail::test
@@ -0,0 +1,43 @@
+#pragma once
+#include <trim/render/repeat.hpp>
+
+#include <doctest/doctest.hpp>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace trim::detail::test
+{
+
+  // the doubling copies only run outside of constant evaluation, they are compared to a glyph by glyph copy
+  TEST_CASE("append_repeated matches appending glyph by glyph")
+  {
+    using namespace std::string_view_literals;
+
+    for(std::string_view glyph : {"x"sv, "é"sv, "─"sv}) {
+      for(size_type count : {1, 2, 7, 8, 9, 15, 16, 17, 31, 32, 33, 64, 100, 128, 1000, 1024}) {
+        CAPTURE(glyph);
+        CAPTURE(count);
+
+        // bytes already in the buffer are kept in front of the run
+        std::string expected = "prefix";
+        for(size_type i = 0; i < count; ++i)
+          expected += glyph;
+
+        std::string string = "prefix";
+        trim::append_repeated(string, glyph, count);
+        CHECK(string == expected);
+
+        std::vector<char> vector = std::vector<char>({'p', 'r', 'e', 'f', 'i', 'x'});
+        trim::append_repeated(vector, glyph, count);
+        CHECK(std::string_view(vector.data(), vector.size()) == expected);
+
+        Byte_Count byte_count {};
+        trim::append_repeated(byte_count, glyph, count);
+        CHECK(byte_count.size + 6 == expected.size());
+      }
+    }
+  }
+
+} // namespace trim::detail::test
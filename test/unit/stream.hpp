@@ -0,0 +1,140 @@
+#pragma once
+#include <trim/scene/parallel.hpp>
+#include <trim/trim.hpp>
+#include <trim/util/memory_ostream.hpp>
+#include <unit/parens.hpp>
+
+#include <doctest/doctest.hpp>
+
+#include <random>
+#include <string>
+
+namespace trim::detail::test
+{
+
+  static consteval auto compute_stream_result(std::string_view input) noexcept
+  {
+    auto parser = trim::Parentheses_Parser {};
+    auto parsed = parser.parse(input);
+    TRIM_ASSERT(parsed.errors.empty());
+    auto layout = make_layout(parsed.tree, parsed.root, parsed.node_labels, parsed.edge_labels, default_style);
+    auto stream = Tree_Stream(parsed.tree, parsed.root, parsed.node_labels, layout);
+
+    std::array<char, 4096> buffer {};
+    Memory_OStream ostream = Memory_OStream(buffer);
+    stream.draw(ostream, default_style);
+    return buffer;
+  }
+
+  // the streaming renderer draws the same rows as a scene holding the whole tree
+  template<std::array streamed = compute_stream_result("((()(()))(())())"), std::array drawn = compute_result("((()(()))(())())")>
+  static constexpr bool test_stream() noexcept
+  {
+    static_assert(streamed == drawn);
+    return true;
+  }
+
+  static_assert(test_stream());
+
+  // render() allocates the exact size of the output and writes the same bytes as draw()
+  static consteval bool test_render(std::string_view input) noexcept
+  {
+    auto parser = trim::Parentheses_Parser {};
+    auto parsed = parser.parse(input);
+    Style style = default_style;
+    style.box_color = Color_RGB::RED;
+    auto layout = make_layout(parsed.tree, parsed.root, parsed.node_labels, parsed.edge_labels, style);
+    auto stream = Tree_Stream(parsed.tree, parsed.root, parsed.node_labels, layout);
+    auto scene = Scene(Tree_Sprite(parsed.tree, parsed.root, parsed.node_labels, parsed.edge_labels, layout));
+
+    Ansi_Options const options = Ansi_Options {.trim_trailing_blanks = true};
+    String_Sink drawn {};
+    stream.draw(drawn, style, stream.rect(), options);
+
+    std::string const streamed = stream.render(style, stream.rect(), options);
+    std::string const rendered = scene.render(style, scene.rect(), options);
+    return streamed == drawn.str() && rendered == drawn.str() && stream.output_size(style, stream.rect(), options) == drawn.str().size()
+        && scene.output_size(style, scene.rect(), options) == drawn.str().size();
+  }
+
+  static_assert(test_render("(()())"));
+
+  // a deep tree, its rows take several rounds of bands
+  static std::pair<Tree, Labels> make_deep_tree(size_type num_nodes, unsigned seed)
+  {
+    std::mt19937 rng = std::mt19937(seed);
+    Tree tree = Tree(num_nodes);
+    Labels labels = Labels(num_nodes);
+    for(size_type node = 0; node < num_nodes; ++node)
+      labels[node] = String(std::string(1 + rng() % 5, 'a'));
+    for(size_type node = 1; node < num_nodes; ++node)
+      tree.add_child(node - 1 - rng() % std::min<size_type>(node, 8), node);
+    return {std::move(tree), std::move(labels)};
+  }
+
+  // bands drawn on several threads, over several rounds, are written in the order of the rows
+  TEST_CASE("draw_parallel matches Tree_Stream::draw")
+  {
+    auto const [tree, labels] = make_deep_tree(2000, 7);
+
+    Style style = default_style;
+    style.box_color = Color_RGB::RED;
+    Tree_Layout const layout = make_layout(tree, 0, labels, labels, style);
+    Tree_Stream const stream = Tree_Stream(tree, 0, labels, layout);
+    Ansi_Options const options = Ansi_Options {.trim_trailing_blanks = true};
+
+    String_Sink expected {};
+    stream.draw(expected, style, stream.rect(), options);
+
+    for(unsigned num_threads : {2u, 3u, 8u}) {
+      CAPTURE(num_threads);
+      String_Sink drawn {};
+      trim::draw_parallel(stream, drawn, style, stream.rect(), num_threads, options);
+      CHECK(drawn.str() == expected.str());
+    }
+  }
+
+  // the bands of a scene together look at each node and branch about once, however many bands there are
+  TEST_CASE("Tree_Line_Index visits the events of a window")
+  {
+    for(size_type num_nodes : {1000, 4000, 16000}) {
+      auto const [tree, labels] = make_deep_tree(num_nodes, 11);
+      Tree_Layout const layout = make_layout(tree, 0, labels, labels, default_style, Layout_Engine::WALKER);
+      Tree_Line_Index const index = Tree_Line_Index(tree, layout);
+      Rect const rect = layout.rect();
+
+      for(coord_type band_lines : {1, 8, 64}) {
+        CAPTURE(num_nodes);
+        CAPTURE(band_lines);
+        size_type looked_at = 0;
+        size_type visited = 0;
+        for(coord_type line = top_line(rect); line <= bot_line(rect); line += band_lines) {
+          Rect const band = Rect(Point(line, left_column(rect)), Point(std::min(line + band_lines - 1, bot_line(rect)), right_column(rect)));
+          looked_at += index.visit(band, [&](size_type, Rect) { visited += 1; });
+        }
+
+        // an event is looked at by the bands it starts in or up to 3 lines, the tallest box, above
+        CHECK(visited >= index.num_events());
+        CHECK(looked_at <= index.num_events() * static_cast<size_type>(1 + (3 + band_lines - 1) / band_lines));
+      }
+    }
+  }
+
+  // the sprites of a window, found in an index shared by the windows, draw the window as the whole tree does
+  TEST_CASE("Tree_Sprite of a window matches the whole tree")
+  {
+    auto const [tree, labels] = make_deep_tree(2000, 13);
+    Tree_Layout const layout = make_layout(tree, 0, labels, labels, default_style);
+    Tree_Line_Index const index = Tree_Line_Index(tree, layout);
+    Scene const whole = Scene(Tree_Sprite(tree, 0, labels, labels, layout));
+    Rect const rect = layout.rect();
+
+    for(coord_type line = top_line(rect); line <= bot_line(rect); line += 37) {
+      CAPTURE(line);
+      Rect const window = Rect(Point(line, left_column(rect) + 5), Point(std::min(line + 24, bot_line(rect)), left_column(rect) + 84));
+      Scene const windowed = Scene(Tree_Sprite(tree, 0, labels, labels, layout, index, window));
+      CHECK(windowed.render(default_style, window) == whole.render(default_style, window));
+    }
+  }
+
+} // namespace trim::detail::test
@@ -0,0 +1,52 @@
+#pragma once
+#include <trim/trim.hpp>
+#include <trim/util/memory_ostream.hpp>
+
+namespace trim::detail::test
+{
+
+  static consteval auto compute_svg_result(std::string_view input) noexcept
+  {
+    auto parser = trim::Parentheses_Parser {};
+    auto parsed = parser.parse(input);
+    TRIM_ASSERT(parsed.errors.empty());
+    auto layout = make_layout(parsed.tree, parsed.root, parsed.node_labels, parsed.edge_labels, default_style);
+
+    std::array<char, 4096> buffer {};
+    Memory_OStream ostream = Memory_OStream(buffer);
+    write_svg(ostream, parsed.tree, parsed.root, parsed.node_labels, layout, default_style);
+    return buffer;
+  }
+
+  // one rect and one text per node and one path per edge, placed on the cells of the text output
+  template<std::array data = compute_svg_result("(()())")>
+  static constexpr bool test_svg() noexcept
+  {
+    using namespace std::string_view_literals;
+    constexpr std::string_view view = std::string_view(data.data());
+    constexpr std::string_view expected = R"EOF(
+<svg xmlns="http://www.w3.org/2000/svg" width="120" height="140" viewBox="0 0 120 140">
+<g fill="none" stroke="black">
+<path d="M55 50V70H25V90"/>
+<path d="M55 50V70H95V90"/>
+</g>
+<g fill="none" stroke="black">
+<rect x="35" y="10" width="40" height="40"/>
+<rect x="5" y="90" width="40" height="40"/>
+<rect x="75" y="90" width="40" height="40"/>
+</g>
+<g font-family="monospace" font-size="16" dominant-baseline="central" xml:space="preserve" fill="black">
+<text><tspan x="50" y="30">0</tspan></text>
+<text><tspan x="20" y="110">1</tspan></text>
+<text><tspan x="90" y="110">2</tspan></text>
+</g>
+</svg>
+)EOF"sv.substr(1);
+
+    static_assert(view == expected);
+    return true;
+  }
+
+  static_assert(test_svg());
+
+} // namespace trim::detail::test
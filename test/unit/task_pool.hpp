@@ -0,0 +1,39 @@
+#pragma once
+#include <trim/util/task_pool.hpp>
+
+#include <doctest/doctest.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace trim::detail::test
+{
+
+  // a task waits for the other tasks to start, which only happens if they run on as many threads at once
+  TEST_CASE("Task_Pool runs tasks on several threads at once")
+  {
+    for(unsigned num_threads : {2u, 4u}) {
+      CAPTURE(num_threads);
+      Task_Pool pool = Task_Pool(num_threads);
+      std::vector<size_type> const weights = std::vector<size_type>(num_threads, 1);
+
+      // the same pool runs several lists of tasks
+      for(int round = 0; round < 3; ++round) {
+        std::atomic<unsigned> started = 0;
+        std::atomic<unsigned> met = 0;
+        pool.run(weights, [&](size_type) -> void {
+          started.fetch_add(1);
+          auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+          while(started.load() < num_threads && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::yield();
+          if(started.load() == num_threads)
+            met.fetch_add(1);
+        });
+        CHECK(met.load() == num_threads);
+      }
+    }
+  }
+
+} // namespace trim::detail::test
@@ -0,0 +1,44 @@
+#pragma once
+#include <trim/trim.hpp>
+#include <trim/util/memory_ostream.hpp>
+
+namespace trim::detail::test
+{
+
+  // draws the window (line, column, height, width) relative to the top left corner of the scene
+  static consteval auto compute_viewport_result(std::string_view input, coord_type line, coord_type column, coord_type height, coord_type width) noexcept
+  {
+    auto parser = trim::Parentheses_Parser {};
+    auto parsed = parser.parse(input);
+    TRIM_ASSERT(parsed.errors.empty());
+    auto layout = make_layout(parsed.tree, parsed.root, parsed.node_labels, parsed.edge_labels, default_style);
+    Point const corner = layout.rect().p1;
+    Rect const window = Rect(Point(corner.line + line, corner.column + column), Point(corner.line + line + height - 1, corner.column + column + width - 1));
+    auto tree = Tree_Sprite(parsed.tree, parsed.root, parsed.node_labels, parsed.edge_labels, layout, window);
+    auto scene = Scene(std::move(tree));
+
+    std::array<char, 4096> buffer {};
+    Memory_OStream ostream = Memory_OStream(buffer);
+    scene.draw(ostream, default_style, window);
+    return buffer;
+  }
+
+  // only the sprites inside the window are built, and the window is drawn as in the full scene
+  template<std::array data = compute_viewport_result("(()())", 3, 6, 3, 6)>
+  static constexpr bool test_viewport() noexcept
+  {
+    using namespace std::string_view_literals;
+    constexpr std::string_view view = std::string_view(data.data());
+    constexpr std::string_view expected = R"EOF(
+───┐  
+ ┌─┴─┐
+ | 2 |
+)EOF"sv.substr(1);
+
+    static_assert(view == expected);
+    return true;
+  }
+
+  static_assert(test_viewport());
+
+} // namespace trim::detail::test